@@ -47,7 +47,7 @@ void Solver::read_cnf(ifstream& in) {
 	int i;
 	unsigned int vars, clauses, unary = 0;
 	set<Lit> s;
-	Clause c;
+	clause_t c;
 
 
 	while (in.peek() == 'c') skipLine(in);
@@ -66,8 +66,7 @@ void Solver::read_cnf(ifstream& in) {
 	while (in.good() && in.peek() != EOF) {
 		i = parseInt(in);
 		if (i == 0) {
-			c.cl().resize(s.size());
-			copy(s.begin(), s.end(), c.cl().begin());
+			c.assign(s.begin(), s.end());
 			switch (c.size()) {
 			case 0: {
 				stringstream num;  // this allows to convert int to string
@@ -75,7 +74,7 @@ void Solver::read_cnf(ifstream& in) {
 				Abort("Empty clause not allowed in input formula (clause " + num.str() + ")", 1); // concatenating strings
 			}
 			case 1: {
-				Lit l = c.cl()[0];
+				Lit l = c[0];
 				// checking if we have conflicting unaries. Sufficiently rare to check it here rather than 
 				// add a check in BCP. 
 				if (state[l2v(l)] != VarState::V_UNASSIGNED)
@@ -89,7 +88,7 @@ void Solver::read_cnf(ifstream& in) {
 			}
 			default: add_clause(c, 0, 1);
 			}
-			c.reset();
+			c.clear();
 			s.clear();
 			continue;
 		}
@@ -99,7 +98,6 @@ void Solver::read_cnf(ifstream& in) {
 		if (ValDecHeuristic == VAL_DEC_HEURISTIC::LITSCORE) bumpLitScore(i);
 		s.insert(i);
 	}	
-	if (VarDecHeuristic == VAR_DEC_HEURISTIC::MINISAT) reset_iterators();
 	cout << "Read " << cnf_size() << " clauses in " << cpuTime() - begin_time << " secs." << endl << "Solving..." << endl;
 }
 
@@ -110,163 +108,298 @@ void Solver::read_cnf(ifstream& in) {
 void Solver::reset() { // invoked initially + every restart
 	dl = 0;
 	max_dl = 0;
-	conflicting_clause_idx = -1;	
+	conflicting_clause = CRef_Undef;	
 	separators.push_back(0); // we want separators[1] to match dl=1. separators[0] is not used.
 	conflicts_at_dl.push_back(0);
 }
 
 
-void Solver::reset_iterators(double where) {
-	m_Score2Vars_it = (where == 0) ? m_Score2Vars.begin() : m_Score2Vars.lower_bound(where);
-	Assert(m_Score2Vars_it != m_Score2Vars.end());
-	m_VarsSameScore_it = m_Score2Vars_it->second.begin();
-	m_should_reset_iterators = false;
-}
-
 void Solver::make_space_for_vars() {
 	state.resize(nvars + 1, VarState::V_UNASSIGNED);
+	lit_val.resize(2 * nvars + 1, static_cast<int8_t>(LitState::L_UNASSIGNED));
 	prev_state.resize(nvars + 1, VarState::V_FALSE); // we set initial assignment with phase-saving to false. 
-	antecedent.resize(nvars + 1, -1);	
+	antecedent.resize(nvars + 1, CRef_Undef);	
 	marked.resize(nvars+1);
+	min_state.resize(nvars + 1, MinState::UNKNOWN);
+	eliminated.resize(nvars + 1);
+	frozen.resize(nvars + 1);
+	elim_touched.resize(nvars + 1, true);
+	target_phase.resize(nvars + 1, VarState::V_UNASSIGNED);
+	best_phase.resize(nvars + 1, VarState::V_UNASSIGNED);
 	dlevel.resize(nvars+1);
+	if (lbd_stamp.size() < static_cast<size_t>(nvars) + 1) lbd_stamp.resize(nvars + 1); // may be longer, see new_decision_level()
 	
 	nlits = 2 * nvars;
 	watches.resize(nlits + 1);
+	bin_watches.resize(nlits + 1);
+	lit_seen.resize(nlits + 1);
+	failed_lit.resize(nlits + 1);
 	LitScore.resize(nlits + 1);
 
 	m_activity.resize(nvars + 1);	
 
-    m_HasVarBeenPutInScore2Vars.resize(nvars + 1, false);
-    for (Var v = 1; v <= nvars; ++v) {
-        if (m_HasVarBeenPutInScore2Vars[v]) continue;
-        // This will put it in the map!
-        bumpVarScore(v);
-    }
+	Var first_new_var = max(1, static_cast<int>(m_heap_idx.size()));
+	m_heap_idx.resize(nvars + 1, -1);
+	vmtf_prev.resize(nvars + 1);
+	vmtf_next.resize(nvars + 1);
+	vmtf_stamp.resize(nvars + 1);
+	lrb_assigned_at.resize(nvars + 1);
+	lrb_participated.resize(nvars + 1);
+	lrb_reasoned.resize(nvars + 1);
+	for (Var v = first_new_var; v <= static_cast<Var>(nvars); ++v) {
+		heap_insert(v);
+		vmtf_enqueue(v);
+	}
 }
 
 void Solver::initialize() {	
     make_space_for_vars();
-	m_curr_activity = 0.0f;
 	for (unsigned int v = 0; v <= nvars; ++v) {			
 		m_activity[v] = 0;		
 	}
 	reset();
 }
 
-void Solver::assert_lit(Lit l) {
+void Solver::assert_lit(Lit l, CRef reason) {
 	trail.push_back(l);
 	int var = l2v(l);
 	if (Neg(l)) prev_state[var] = state[var] = VarState::V_FALSE; else prev_state[var] = state[var] = VarState::V_TRUE;
-	dlevel[var] = dl;
-	++num_assignments;
-	if (verbose_now()) cout << l2rl(l) <<  " @ " << dl << endl;
-}
-
-
-void Solver::temporary_assert(Lit l) {
-    indices_of_temporary_assertions.insert(trail.size());
-	trail.push_back(l);
-	int var = l2v(l);
-	if (Neg(l)) prev_state[var] = state[var] = VarState::V_FALSE; else prev_state[var] = state[var] = VarState::V_TRUE;
-	dlevel[var] = dl;
+	lit_val[l] = static_cast<int8_t>(LitState::L_SAT);
+	lit_val[negate_(l)] = static_cast<int8_t>(LitState::L_UNSAT);
+	// with chronological backtracking an implication may belong to a level below dl.
+	dlevel[var] = (chrono && reason != CRef_Undef) ? reason_level(l, reason) : dl;
+	antecedent[var] = reason;
+	if (VarDecHeuristic == VAR_DEC_HEURISTIC::LRB) {
+		lrb_assigned_at[var] = num_learned;
+		lrb_participated[var] = lrb_reasoned[var] = 0;
+	}
 	++num_assignments;
-	if (verbose_now()) cout << l2rl(l) <<  " @ " << dl << endl;
+	if (verbose_now()) cout << l2rl(l) <<  " @ " << dlevel[var] << endl;
 }
 
-
-vector<int> vector_without_indices(const vector<int>& v, const unordered_set<int>& indices) {
-    vector<int> result;
-    for (int i = 0; i < v.size(); ++i) {
-        if (indices.find(i) == indices.end()) {
-            result.push_back(v[i]);
-        }
-    }
-    return result;
+// the highest level of the other (false) literals of the reason of l.
+int Solver::reason_level(Lit l, CRef reason) {
+	if (is_bin_ref(reason)) return dlevel[l2v(bin_ref_lit(reason))];
+	int level = 0;
+	for (Lit other : ca[reason]) 
+		if (other != l) level = max(level, dlevel[l2v(other)]);
+	return level;
 }
 
-
-void Solver::unassert_temporaries() {
-    for (auto i : indices_of_temporary_assertions) {
-        Lit l = trail[i];
-        int var = l2v(l);
-        // Revert the state vector's cell to it's default state.
-        // prev_state[var] = VarState::V_FALSE;
-        state[var] = VarState::V_UNASSIGNED;
-        dlevel[var] = 0; // TODO: Is this correct? Who knows! (actual todo: what does dlevel hold for variables that are assigned?)
-        --num_assignments;
-    }
-    trail = vector_without_indices(trail, indices_of_temporary_assertions);
-
-    // .clear() is not enough - we don't want to keep the memory allocated.
-    indices_of_temporary_assertions = unordered_set<int>();
+void Solver::unassign(Var v) {
+	state[v] = VarState::V_UNASSIGNED;
+	lit_val[v2l(v)] = lit_val[v2l(-v)] = static_cast<int8_t>(LitState::L_UNASSIGNED);
+	if (VarDecHeuristic == VAR_DEC_HEURISTIC::LRB) lrb_reward(v);
+	if (uses_heap() && !heap_contains(v)) heap_insert(v); // lazy reinsertion
+	if (VarDecHeuristic == VAR_DEC_HEURISTIC::VMTF && vmtf_stamp[v] > vmtf_stamp[vmtf_search]) vmtf_search = v;
 }
 
 
-void Solver::m_rescaleScores(double& new_score) {
+void Solver::m_rescaleScores() {
 	if (verbose_now()) cout << "Rescale" << endl;
-	new_score /= Rescale_threshold;
 	for (unsigned int i = 1; i <= nvars; i++)
 		m_activity[i] /= Rescale_threshold;
 	m_var_inc /= Rescale_threshold;
-	// rebuilding the scaled-down m_Score2Vars.
-	map<double, unordered_set<Var>, greater<double>> tmp_map;
-	double prev_score = 0.0f;
-	for (auto m : m_Score2Vars) {
-		double scaled_score = m.first / Rescale_threshold;
-		if (scaled_score == prev_score) // This can happen due to rounding
-			tmp_map[scaled_score].insert(m_Score2Vars[m.first].begin(), m_Score2Vars[m.first].end());
-		else
-			tmp_map[scaled_score] = m_Score2Vars[m.first];
-		prev_score = scaled_score;
+	// Scaling all the scores by the same factor keeps the heap ordered.
+}
+
+void Solver::heap_up(int i) {
+	Var v = m_heap[i];
+	while (i > 0) {
+		int parent = (i - 1) >> 1;
+		if (m_activity[m_heap[parent]] >= m_activity[v]) break;
+		m_heap[i] = m_heap[parent];
+		m_heap_idx[m_heap[i]] = i;
+		i = parent;
 	}
-	tmp_map.swap(m_Score2Vars);
+	m_heap[i] = v;
+	m_heap_idx[v] = i;
+}
+
+void Solver::heap_down(int i) {
+	Var v = m_heap[i];
+	int size = m_heap.size();
+	while (2 * i + 1 < size) {
+		int child = 2 * i + 1;
+		if (child + 1 < size && m_activity[m_heap[child + 1]] > m_activity[m_heap[child]]) ++child;
+		if (m_activity[m_heap[child]] <= m_activity[v]) break;
+		m_heap[i] = m_heap[child];
+		m_heap_idx[m_heap[i]] = i;
+		i = child;
+	}
+	m_heap[i] = v;
+	m_heap_idx[v] = i;
+}
+
+void Solver::heap_insert(Var v) {
+	m_heap_idx[v] = m_heap.size();
+	m_heap.push_back(v);
+	heap_up(m_heap_idx[v]);
+}
+
+Var Solver::heap_remove_max() {
+	Var top = m_heap[0];
+	m_heap[0] = m_heap.back();
+	m_heap_idx[m_heap[0]] = 0;
+	m_heap_idx[top] = -1;
+	m_heap.pop_back();
+	if (m_heap.size() > 1) heap_down(0);
+	return top;
 }
 
 void Solver::bumpVarScore(int var_idx) {
-	double new_score;
-	double score = m_activity[var_idx];		
+	m_activity[var_idx] += m_var_inc;
 
-	if (score > 0) {
-		Assert(m_Score2Vars.find(score) != m_Score2Vars.end());
-		m_Score2Vars[score].erase(var_idx);
-		if (m_Score2Vars[score].size() == 0) m_Score2Vars.erase(score);
+	// Rescaling, to avoid overflows; 
+	if (m_activity[var_idx] > Rescale_threshold) {
+		m_rescaleScores();
 	}
-	new_score = score + m_var_inc;
-	m_activity[var_idx] = new_score;
 
-	// Rescaling, to avoid overflows; 
-	if (new_score > Rescale_threshold) {
-		m_rescaleScores(new_score);
+	if (heap_contains(var_idx)) heap_up(m_heap_idx[var_idx]);
+}
+
+void Solver::vmtf_enqueue(Var v) { // puts v at the front of the queue
+	vmtf_prev[v] = vmtf_last;
+	vmtf_next[v] = 0;
+	if (vmtf_last) vmtf_next[vmtf_last] = v; else vmtf_first = v;
+	vmtf_last = v;
+	vmtf_stamp[v] = ++vmtf_time;
+	if (state[v] == VarState::V_UNASSIGNED) vmtf_search = v;
+}
+
+void Solver::vmtf_dequeue(Var v) {
+	if (vmtf_prev[v]) vmtf_next[vmtf_prev[v]] = vmtf_next[v]; else vmtf_first = vmtf_next[v];
+	if (vmtf_next[v]) vmtf_prev[vmtf_next[v]] = vmtf_prev[v]; else vmtf_last = vmtf_prev[v];
+	if (vmtf_search == v) vmtf_search = vmtf_next[v] ? vmtf_next[v] : vmtf_prev[v];
+}
+
+void Solver::vmtf_bump_analyzed() {
+	// Moving the variables in the order of their stamps keeps their relative order in the queue.
+	sort(vmtf_analyzed.begin(), vmtf_analyzed.end(), [this](Var a, Var b) { return vmtf_stamp[a] < vmtf_stamp[b]; });
+	for (Var v : vmtf_analyzed) {
+		if (v == vmtf_last) continue;
+		vmtf_dequeue(v);
+		vmtf_enqueue(v);
 	}
+	vmtf_analyzed.clear();
+}
 
-	if (m_Score2Vars.find(new_score) != m_Score2Vars.end())
-		m_Score2Vars[new_score].insert(var_idx);
-	else {
-		m_Score2Vars[new_score] = unordered_set<int>({ var_idx });
-        m_HasVarBeenPutInScore2Vars[var_idx] = true;
-    }
+// Called when v is unassigned: its reward is the fraction of the conflicts since it was assigned 
+// that it took part in (directly, or through the reasons of the learned clause).
+void Solver::lrb_reward(Var v) {
+	int interval = num_learned - lrb_assigned_at[v];
+	if (interval <= 0) return;
+	double reward = static_cast<double>(lrb_participated[v] + lrb_reasoned[v]) / interval;
+	m_activity[v] = (1 - lrb_step) * m_activity[v] + lrb_step * reward;
+	if (heap_contains(v)) heap_update(v);
+}
+
+// The "reason side rate" of LRB: variables that implied the literals of the learned clause are rewarded as well.
+void Solver::lrb_bump_reasons(const clause_t& learned) {
+	for (Lit l : learned) {
+		CRef r = antecedent[l2v(l)];
+		if (r == CRef_Undef) continue;
+		if (is_bin_ref(r)) {
+			Var w = l2v(bin_ref_lit(r));
+			if (!marked[w]) ++lrb_reasoned[w];
+		}
+		else for (Lit o : ca[r]) {
+			Var w = l2v(o);
+			if (!marked[w]) ++lrb_reasoned[w];
+		}
+	}
 }
 
 void Solver::bumpLitScore(int lit_idx) {
 	LitScore[lit_idx]++;
 }
 
-void Solver::add_clause(Clause& c, int l, int r) {	
-	Assert(c.size() > 1) ;
+CRef Solver::add_clause(const clause_t& lits, int l, int r, bool learnt) {	
+	Assert(lits.size() > 1) ;
+	if (!learnt) {
+		elim_pending = subsume_pending = true;
+		for (Lit x : lits) touch(x);
+	}
+	if (lits.size() == 2) { // binary clauses live only in the implication lists.
+		add_bin_clause(lits[l], lits[r]);
+		return CRef_Undef;
+	}
+	CRef cr = ca.alloc(lits, learnt);
+	Clause& c = ca[cr];
 	c.lw_set(l);
 	c.rw_set(r);
-	int loc = static_cast<int>(cnf.size());  // the first is in location 0 in cnf	
-	int size = c.size();
 	
-	watches[c.lit(l)].push_back(loc); 
-	watches[c.lit(r)].push_back(loc);
-	cnf.push_back(c);
+	watches[c.lit(l)].push_back({ cr, c.lit(r) }); 
+	watches[c.lit(r)].push_back({ cr, c.lit(l) });
+	if (learnt) learnts.push_back(cr);
+	else cnf.push_back(cr);
+	return cr;
+}
+
+void Solver::add_bin_clause(Lit l, Lit r) {
+	bin_watches[l].push_back(r);
+	bin_watches[r].push_back(l);
+	++nbins;
 }
 
 void Solver::add_unary_clause(Lit l) {		
 	unaries.push_back(l);
 }
 
+/*
+	Adds a clause of the user (incrementally) to a solver that may be in the middle of a search, without restarting it. 
+	Duplicate literals and literals false at level 0 are removed, and a tautology or a clause satisfied at level 0 is dropped. 
+	The watches are the two best literals: true at the lowest level, then unassigned, then false at the highest level. If the clause 
+	is unit or false under the assignment (including when its only true literal was assigned after its other literals became false), 
+	the solver backtracks just below the point where it became so, and asserts the literal it implies. 
+	The rest of the propagation waits for the next BCP().
+*/
+void Solver::add_input_clause(clause_t& lits) {
+	size_t j = 0;
+	bool satisfied = false;
+	for (Lit l : lits) {
+		if (lit_seen[l]) continue;
+		if (lit_seen[negate_(l)]) satisfied = true; // a tautology
+		LitState ls = lit_state(l);
+		if (ls != LitState::L_UNASSIGNED && dlevel[l2v(l)] == 0) {
+			if (ls == LitState::L_SAT) satisfied = true;
+			continue;
+		}
+		lit_seen[l] = true;
+		lits[j++] = l;
+	}
+	lits.resize(j);
+	for (Lit l : lits) lit_seen[l] = false;
+	if (satisfied) return;
+	if (lits.empty()) {
+		inconsistent = true;
+		return;
+	}
+	if (lits.size() == 1) {
+		if (dl > 0) cancel_until(0);
+		add_unary_clause(lits[0]);
+		assert_lit(lits[0]);
+		return;
+	}
+	auto rank = [this](Lit l) { 
+		LitState ls = lit_state(l);
+		return ls == LitState::L_SAT ? dlevel[l2v(l)] : ls == LitState::L_UNASSIGNED ? dl + 1 : 2 * dl + 2 - dlevel[l2v(l)]; 
+	};
+	sort(lits.begin(), lits.end(), [&](Lit a, Lit b) { return rank(a) < rank(b); });
+	bool implies = false;
+	if (lit_state(lits[1]) == LitState::L_UNSAT) {
+		int level = dlevel[l2v(lits[1])];
+		LitState first = lit_state(lits[0]);
+		if (first == LitState::L_UNSAT && dlevel[l2v(lits[0])] == level) cancel_until(level - 1); // both watches become unassigned
+		else if (first == LitState::L_UNASSIGNED || dlevel[l2v(lits[0])] > level) { // lits[0] may be true, but only since after level
+			if (dl > level) cancel_until(level);
+			implies = true;
+		}
+	}
+	CRef cr = add_clause(lits, 0, 1);
+	if (implies) assert_lit(lits[0], lits.size() == 2 ? bin_ref(lits[1]) : cr);
+}
+
 int Solver :: getVal(Var v) {
 	switch (ValDecHeuristic) {
 	case VAL_DEC_HEURISTIC::PHASESAVING: {
@@ -277,6 +410,10 @@ int Solver :: getVal(Var v) {
 		default: Assert(0);
 		}
 	}
+	case VAL_DEC_HEURISTIC::TARGET: {
+		VarState phase = target_phase[v] != VarState::V_UNASSIGNED ? target_phase[v] : prev_state[v];
+		return phase == VarState::V_TRUE ? v2l(v) : v2l(-v);
+	}
 	case VAL_DEC_HEURISTIC::LITSCORE:
 	{
 		int litp = v2l(v), litn = v2l(-v);
@@ -290,45 +427,64 @@ int Solver :: getVal(Var v) {
 
 SolverState Solver::decide(){
 	if (verbose_now()) cout << "decide" << endl;
+	// The assumptions come first, each at a decision level of its own. One that is already true gets an empty level, 
+	// so that level i + 1 always belongs to assumption i; one that is false makes the formula unsatisfiable under them.
+	while (dl < static_cast<int>(assumptions.size())) {
+		Lit p = assumptions[dl];
+		LitState ps = lit_state(p);
+		if (ps == LitState::L_UNSAT) {
+			analyze_final(p);
+			return SolverState::UNSAT;
+		}
+		new_decision_level();
+		if (ps == LitState::L_UNASSIGNED) {
+			assert_lit(p);
+			return SolverState::UNDEF;
+		}
+	}
 	Lit best_lit = 0;	
 	int max_score = 0;
 	Var bestVar = 0;
 	switch (VarDecHeuristic) {
 
-	case  VAR_DEC_HEURISTIC::MINISAT: {
-		// m_Score2Vars_r_it and m_VarsSameScore_it are fields. 
-		// When we get here they are the location where we need to start looking. 		
-		if (m_should_reset_iterators) reset_iterators(m_curr_activity);
-		Var v = 0;
-		int cnt = 0;
-		if (m_Score2Vars_it == m_Score2Vars.end()) break;
-		while (true) { // scores from high to low
-			while (m_VarsSameScore_it != m_Score2Vars_it->second.end()) {
-				v = *m_VarsSameScore_it;
-				++m_VarsSameScore_it;
-				++cnt;
-				if (state[v] == VarState::V_UNASSIGNED) { // found a var to assign
-					m_curr_activity = m_Score2Vars_it->first;
-					assert(m_curr_activity == m_activity[v]);
-					best_lit = getVal(v);					
-					goto Apply_decision;
-				}
+	case  VAR_DEC_HEURISTIC::MINISAT: 
+	case  VAR_DEC_HEURISTIC::LRB: {
+		// Assigned variables are left in the heap by assert_lit(), so they are dropped here on the way to the top unassigned one.
+		while (!m_heap.empty()) {
+			Var v = heap_remove_max();
+			if (decidable(v)) { // found a var to assign
+				best_lit = getVal(v);					
+				goto Apply_decision;
 			}
-			++m_Score2Vars_it;
-			if (m_Score2Vars_it == m_Score2Vars.end()) break;
-			m_VarsSameScore_it = m_Score2Vars_it->second.begin();
 		}
 		break;
 	}
+	case VAR_DEC_HEURISTIC::VMTF: {
+		// Everything after vmtf_search is assigned (or eliminated), so this is amortized O(1) per decision.
+		Var v = vmtf_search;
+		while (v && !decidable(v)) v = vmtf_prev[v];
+		if (!v) break;
+		vmtf_search = v;
+		best_lit = getVal(v);
+		goto Apply_decision;
+	}
 	default: Assert(0);
 	}	
 		
 	assert(!best_lit);
+	extend_model();
 	S.print_state(Assignment_file);
 	return SolverState::SAT;
 
 
 Apply_decision:	
+	new_decision_level();
+	assert_lit(best_lit);
+	++num_decisions;	
+	return SolverState::UNDEF;
+}
+
+void Solver::new_decision_level() {
 	dl++; // increase decision level
 	if (dl > max_dl) {
 		max_dl = dl;
@@ -339,25 +495,22 @@ Apply_decision:
 		separators[dl] = trail.size();
 		conflicts_at_dl[dl] = num_learned;
 	}
-	
-	assert_lit(best_lit);
-	++num_decisions;	
-	return SolverState::UNDEF;
+	// the empty levels of assumptions that are already true may take dl past nvars
+	if (lbd_stamp.size() <= static_cast<size_t>(dl)) lbd_stamp.resize(dl + 1);
 }
 
-inline ClauseState Clause::next_not_false(bool is_left_watch, Lit other_watch, bool binary, int& loc) {  
+inline ClauseState Clause::next_not_false(bool is_left_watch, Lit other_watch, int& loc) {  
 	if (verbose_now()) cout << "next_not_false" << endl;
 	
-	if (!binary)
-		for (vector<int>::iterator it = c.begin(); it != c.end(); ++it) {
-			LitState LitState = S.lit_state(*it);
-			if (LitState != LitState::L_UNSAT && *it != other_watch) { // found another watch_lit
-				loc = distance(c.begin(), it);
-				if (is_left_watch) lw = loc;    // if literal was the left one 
-				else rw = loc;				
-				return ClauseState::C_UNDEF;
-			}
+	for (Lit* it = begin(); it != end(); ++it) {
+		LitState LitState = S.lit_state(*it);
+		if (LitState != LitState::L_UNSAT && *it != other_watch) { // found another watch_lit
+			loc = distance(begin(), it);
+			if (is_left_watch) lw = loc;    // if literal was the left one 
+			else rw = loc;				
+			return ClauseState::C_UNDEF;
 		}
+	}
 	switch (S.lit_state(other_watch)) {
 	case LitState::L_UNSAT: // conflict
 		if (verbose_now()) { print_real_lits(); cout << " is conflicting" << endl; }
@@ -369,12 +522,15 @@ inline ClauseState Clause::next_not_false(bool is_left_watch, Lit other_watch, b
 }
 
 void Solver::test() { // tests that each clause is watched twice. 	
-	for (unsigned int idx = 0; idx < cnf.size(); ++idx) {
-		Clause c = cnf[idx];
+	vector<CRef> all(cnf);
+	all.insert(all.end(), learnts.begin(), learnts.end());
+	for (unsigned int idx = 0; idx < all.size(); ++idx) {
+		Clause& c = ca[all[idx]];
 		bool found = false;
 		for (int zo = 0; zo <= 1; ++zo) {
-			for (vector<int>::iterator it = watches[c.cl()[zo]].begin(); !found && it != watches[c.cl()[zo]].end(); ++it) {				
-				if (*it == idx) {
+			Lit w = zo ? c.get_rw_lit() : c.get_lw_lit();
+			for (vector<Watcher>::iterator it = watches[w].begin(); !found && it != watches[w].end(); ++it) {				
+				if (it->cref == all[idx]) {
 					found = true;
 					break;
 				}
@@ -395,31 +551,61 @@ SolverState Solver::BCP() {
 	if (verbose_now()) cout << "qhead = " << qhead << " trail-size = " << trail.size() << endl;
 	while (qhead < trail.size()) { 
 		Lit NegatedLit = negate_(trail[qhead++]);
+		++num_propagations;
 		Assert(lit_state(NegatedLit) == LitState::L_UNSAT);
 		if (verbose_now()) cout << "propagating " << l2rl(negate_(NegatedLit)) << endl;
-		vector<int> new_watch_list; // The original watch list minus those clauses that changed a watch. The order is maintained. 
-		int new_watch_list_idx = watches[NegatedLit].size() - 1; // Since we are traversing the watch_list backwards, this index goes down.
-		new_watch_list.resize(watches[NegatedLit].size());
-		for (vector<int>::reverse_iterator it = watches[NegatedLit].rbegin(); it != watches[NegatedLit].rend() && conflicting_clause_idx < 0; ++it) {
-			Clause& c = cnf[*it];
+		// Binary clauses first: they need no clause access, and they give short reasons.
+		for (Lit implied : bin_watches[NegatedLit]) {
+			LitState implied_state = lit_state(implied);
+			if (implied_state == LitState::L_SAT) continue;
+			if (implied_state == LitState::L_UNASSIGNED) {
+				assert_lit(implied, bin_ref(NegatedLit));
+				if (verbose_now()) cout << "new binary implication <- " << l2rl(implied) << endl;
+				continue;
+			}
+			if (verbose_now()) cout << "binary conflict (" << l2rl(NegatedLit) << " " << l2rl(implied) << ")" << endl;
+			if (dl == 0) {
+				inconsistent = true;
+				return SolverState::UNSAT;
+			}
+			conflicting_clause = bin_ref(implied);
+			conflicting_lit = NegatedLit;
+			return SolverState::CONFLICT;
+		}
+		// The watch list is compacted in place: 'i' reads the entries and 'j' writes back the ones that stay.
+		vector<Watcher>& ws = watches[NegatedLit];
+		vector<Watcher>::iterator i = ws.begin(), j = ws.begin(), end = ws.end();
+		while (i != end) {
+			if (lit_state(i->blocker) == LitState::L_SAT) { // the clause is satisfied; no need to look at it.
+				*j++ = *i++;
+				continue;
+			}
+			if (i->cref == ignored_clause) { // vivify() is trying it
+				*j++ = *i++;
+				continue;
+			}
+			CRef cr = i->cref;
+			++i;
+			Clause& c = ca[cr];
 			Lit l_watch = c.get_lw_lit(), 
 				r_watch = c.get_rw_lit();			
-			bool binary = c.size() == 2;
 			bool is_left_watch = (l_watch == NegatedLit);
 			Lit other_watch = is_left_watch? r_watch: l_watch;
-			int NewWatchLocation;
-			ClauseState res = c.next_not_false(is_left_watch, other_watch, binary, NewWatchLocation);
-			if (res != ClauseState::C_UNDEF) new_watch_list[new_watch_list_idx--] = *it; //in all cases but the move-watch_lit case we leave watch_lit where it is
+			Watcher w = { cr, other_watch }; // the other watch is the best blocker we know of.
+			if (lit_state(other_watch) == LitState::L_SAT) {
+				if (verbose_now()) cout << "clause is sat" << endl;
+				*j++ = w;
+				continue;
+			}
+			int NewWatchLocation = 0; // set by next_not_false() when it returns C_UNDEF
+			ClauseState res = c.next_not_false(is_left_watch, other_watch, NewWatchLocation);
+			if (res != ClauseState::C_UNDEF) *j++ = w; //in all cases but the move-watch_lit case we leave watch_lit where it is
 			switch (res) {
 			case ClauseState::C_UNSAT: { // conflict				
 				if (verbose_now()) print_state();
-				if (dl == 0) return SolverState::UNSAT;				
-				conflicting_clause_idx = *it;  // this will also break the loop
-				 int dist = distance(it, watches[NegatedLit].rend()) - 1; // # of entries in watches[NegatedLit] that were not yet processed when we hit this conflict. 
+				conflicting_clause = cr;
 				// Copying the remaining watched clauses:
-				for (int i = dist - 1; i >= 0; i--) {
-					new_watch_list[new_watch_list_idx--] = watches[NegatedLit][i];
-				}
+				while (i != end) *j++ = *i++;
 				if (verbose_now()) cout << "conflict" << endl;
 				break;
 			}
@@ -428,31 +614,949 @@ SolverState Solver::BCP() {
 				break; // nothing to do when clause has a satisfied literal.
 			case ClauseState::C_UNIT: { // new implication				
 				if (verbose_now()) cout << "propagating: ";
-				assert_lit(other_watch);
-				antecedent[l2v(other_watch)] = *it;
+				assert_lit(other_watch, cr);
 				if (verbose_now()) cout << "new implication <- " << l2rl(other_watch) << endl;
 				break;
 			}
 			default: // replacing watch_lit
 				Assert(NewWatchLocation < static_cast<int>(c.size()));
 				int new_lit = c.lit(NewWatchLocation);
-				watches[new_lit].push_back(*it);
+				watches[new_lit].push_back(w);
 				if (verbose_now()) { c.print_real_lits(); cout << " now watched by " << l2rl(new_lit) << endl;}
 			}
 		}
-		// resetting the list of clauses watched by this literal.
-		watches[NegatedLit].clear();
-		new_watch_list_idx++; // just because of the redundant '--' at the end. 		
-		watches[NegatedLit].insert(watches[NegatedLit].begin(), new_watch_list.begin() + new_watch_list_idx, new_watch_list.end());
+		ws.erase(j, end);
 
 		//print_watches();
-		if (conflicting_clause_idx >= 0) return SolverState::CONFLICT;
-		new_watch_list.clear();
+		if (conflicting_clause != CRef_Undef) {
+			if (dl == 0) {
+				conflicting_clause = CRef_Undef;
+				inconsistent = true;
+				return SolverState::UNSAT;
+			}
+			return SolverState::CONFLICT;
+		}
 	}
 	return SolverState::UNDEF;
 }
 
 
+/******************  Learned clauses DB ******************************/
+
+template<class It> int Solver::compute_lbd(It begin, It end) {
+	++lbd_time;
+	int lbd = 0;
+	for (It it = begin; it != end; ++it) {
+		int level = dlevel[l2v(*it)];
+		if (level > 0 && lbd_stamp[level] != lbd_time) { // level 0 is not a decision level
+			lbd_stamp[level] = lbd_time;
+			++lbd;
+		}
+	}
+	return lbd;
+}
+
+// Called for learned clauses that take part in conflict analysis: their lbd may have improved, and they are marked as used.
+void Solver::bump_clause(CRef cr) {
+	Clause& c = ca[cr];
+	if (!c.is_learnt()) return;
+	int lbd = compute_lbd(c.begin(), c.end());
+	if (lbd < c.get_lbd()) c.set_lbd(lbd);
+	c.set_used(c.get_lbd() <= Tier2_lbd ? 2 : 1);
+}
+
+// A clause is locked while it is the antecedent of one of its literals; it cannot be deleted then.
+// The implied literal is always one of the watches.
+bool Solver::locked(CRef cr) {
+	Clause& c = ca[cr];
+	Lit l = c.get_lw_lit(), r = c.get_rw_lit();
+	return (lit_state(l) == LitState::L_SAT && antecedent[l2v(l)] == cr) ||
+		(lit_state(r) == LitState::L_SAT && antecedent[l2v(r)] == cr);
+}
+
+/*
+	Core clauses (lbd <= Tier1_lbd) are never deleted. Other learned clauses survive a reduction if they were 
+	used in conflict analysis since the previous one (tier-2 clauses get two rounds of grace). Among those that were not, 
+	the worst half (by lbd, then size) is deleted.
+*/
+void Solver::reduce_db() {
+	if (verbose_now()) cout << "reduce_db" << endl;
+	++num_reductions;
+	vector<CRef> candidates;
+	size_t j = 0;
+	for (size_t i = 0; i < learnts.size(); ++i) {
+		CRef cr = learnts[i];
+		Clause& c = ca[cr];
+		if (c.get_lbd() <= Tier1_lbd || locked(cr)) learnts[j++] = cr;
+		else if (c.get_used()) {
+			c.set_used(c.get_used() - 1);
+			learnts[j++] = cr;
+		}
+		else candidates.push_back(cr);
+	}
+	learnts.resize(j);
+	sort(candidates.begin(), candidates.end(), [this](CRef a, CRef b) { 
+		Clause &ca_ = ca[a], &cb = ca[b];
+		return ca_.get_lbd() > cb.get_lbd() || (ca_.get_lbd() == cb.get_lbd() && ca_.size() > cb.size()); 
+	});
+	size_t to_delete = candidates.size() / 2;
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		if (i < to_delete) ca.free(candidates[i]);
+		else learnts.push_back(candidates[i]);
+	}
+	num_deleted += to_delete;
+
+	// detaching the deleted clauses.
+	for (vector<Watcher>& ws : watches) 
+		ws.erase(remove_if(ws.begin(), ws.end(), [this](const Watcher& w) { return ca[w.cref].is_deleted(); }), ws.end());
+
+	reduce_interval += Reduce_increment;
+	next_reduce = num_learned + reduce_interval;
+	if (ca.wasted() > ca.size() * Garbage_fraction) garbage_collect();
+	if (verbose >= 1) cout << "reduce_db: deleted " << to_delete << " clauses, " << learnts.size() << " learned clauses left" << endl;
+}
+
+// Compacts the arena by moving the live clauses to a fresh one, and updating every CRef that points to them.
+void Solver::garbage_collect() {
+	ClauseArena to;
+	to.reserve(ca.size() - ca.wasted());
+	for (vector<Watcher>& ws : watches) 
+		for (Watcher& w : ws) w.cref = ca.relocate(w.cref, to);
+	for (Var v = 1; v <= static_cast<Var>(nvars); ++v) {
+		CRef& r = antecedent[v];
+		if (state[v] == VarState::V_UNASSIGNED) r = CRef_Undef;
+		else if (r != CRef_Undef && !is_bin_ref(r)) r = ca.relocate(r, to);
+	}
+	for (CRef& cr : cnf) cr = ca.relocate(cr, to);
+	for (CRef& cr : learnts) cr = ca.relocate(cr, to);
+	if (asserting_clause != CRef_Undef && !is_bin_ref(asserting_clause)) asserting_clause = ca.relocate(asserting_clause, to);
+	if (verbose >= 1) cout << "garbage collection: " << ca.size() << " -> " << to.size() << " words" << endl;
+	ca = move(to);
+}
+
+/******************  Simplification ******************************/
+
+/*
+	Invoked at level 0, when it has new literals. Those literals are fixed for good, so clauses they satisfy are deleted, 
+	and false literals are removed from the other clauses. 
+*/
+void Solver::simplify() {
+	if (verbose_now()) cout << "simplify" << endl;
+	Assert(dl == 0);
+	++num_simplifications;
+	// the fixed literals become unary clauses, so that they survive the deletion of the clauses that imply them.
+	for (Lit l : unaries) marked[l2v(l)] = true;
+	for (Lit l : trail) 
+		if (!marked[l2v(l)]) {
+			add_unary_clause(l);
+			marked[l2v(l)] = true;
+		}
+	for (Lit l : unaries) marked[l2v(l)] = false;
+	for (unsigned int v = 1; v <= nvars; ++v) 
+		if (state[v] != VarState::V_UNASSIGNED) antecedent[v] = CRef_Undef; // so that no clause is locked
+	
+	// binary clauses: BCP is done, so a binary clause with a false literal is satisfied by its other literal. 
+	for (Lit l : trail) {
+		for (Lit other : bin_watches[l]) {
+			vector<Lit>& ws = bin_watches[other];
+			ws.erase(find(ws.begin(), ws.end(), l));
+			touch(other);
+			--nbins;
+			++num_satisfied;
+		}
+		bin_watches[l].clear();
+	}
+
+	auto simplify_clauses = [this](vector<CRef>& crefs) {
+		size_t j = 0;
+		for (CRef cr : crefs) {
+			Clause& c = ca[cr];
+			bool satisfied = false;
+			size_t size = 0;
+			for (Lit l : c) {
+				LitState ls = lit_state(l);
+				if (ls == LitState::L_SAT) { satisfied = true; break; }
+				if (ls == LitState::L_UNASSIGNED) ++size;
+			}
+			if (!c.is_learnt() && (satisfied || size < c.size())) for (Lit l : c) touch(l);
+			if (satisfied) {
+				ca.free(cr);
+				++num_satisfied;
+				continue;
+			}
+			// BCP is done, so normally at least two literals are left. Not so for a clause that was added (ipasir_add) 
+			// while its literals were already assigned: it is left as it is.
+			if (size < 2) {
+				crefs[j++] = cr;
+				continue;
+			}
+			num_false_lits += c.size() - size;
+			size = 0;
+			for (Lit l : c) 
+				if (lit_state(l) == LitState::L_UNASSIGNED) c.begin()[size++] = l;
+			if (size == 2) {
+				add_bin_clause(c.lit(0), c.lit(1));
+				ca.free(cr);
+				continue;
+			}
+			if (size < c.size()) ca.shrink(cr, size);
+			c.lw_set(0);
+			c.rw_set(1);
+			crefs[j++] = cr;
+		}
+		crefs.resize(j);
+	};
+	simplify_clauses(cnf);
+	simplify_clauses(learnts);
+	// the watches of the remaining clauses are rebuilt, as their literals moved.
+	for (vector<Watcher>& ws : watches) ws.clear();
+	for (vector<CRef>* crefs : { &cnf, &learnts }) 
+		for (CRef cr : *crefs) {
+			Clause& c = ca[cr];
+			watches[c.get_lw_lit()].push_back({ cr, c.get_rw_lit() });
+			watches[c.get_rw_lit()].push_back({ cr, c.get_lw_lit() });
+		}
+	simplified_units = trail.size();
+	if (ca.wasted() > ca.size() * Garbage_fraction) garbage_collect();
+	if (verbose >= 1) cout << "simplify: " << trail.size() << " fixed literals, " << cnf.size() + learnts.size() + nbins << " clauses left" << endl;
+}
+
+/*
+	The inprocessing scheduler. It runs after a full restart (at level 0) the passes that are due, each with a budget that is 
+	proportional to the propagations of the search since the pass last ran, so that on easy instances they take little time. 
+	The propagations of the passes themselves are not counted as search. Unary clauses that a pass derives are propagated before the next one.
+	While a pass is due, restarts do not reuse the trail, and do not keep the levels of the assumptions, so that they get to level 0.
+*/
+SolverState Solver::inprocess() {
+	if (verbose_now()) cout << "inprocess" << endl;
+	inprocess_pending = false;
+	long long propagations = num_propagations;
+	SolverState res = SolverState::UNDEF;
+	for (Pass* p : passes()) {
+		if (!(this->*p->due)()) continue;
+		double start = cpuTime();
+		long long search = search_propagations();
+		p->budget = max<long long>(p->min_budget, p->effort * (search - p->last));
+		res = (this->*p->run)();
+		if (res != SolverState::UNSAT) res = BCP(); // at level 0: UNSAT or UNDEF
+		if (res != SolverState::UNSAT && simplify_due()) simplify();
+		inprocess_propagations += num_propagations - propagations;
+		propagations = num_propagations;
+		p->last = search;
+		p->next = num_learned + p->interval;
+		++p->runs;
+		p->time += cpuTime() - start;
+		if (res == SolverState::UNSAT) break;
+	}
+	return res;
+}
+
+string Solver::inprocess_stats() {
+	stringstream s;
+	for (Pass* p : passes()) 
+		s << p->name << " " << p->runs << " (" << p->time << " s)" << (p == &vivify_pass ? "" : ", ");
+	return s.str();
+}
+
+/*
+	Subsumption: a clause D subsumes C if D is a subset of C, and then C is deleted. Self-subsuming resolution: if D is a subset of C 
+	except for one literal whose negation is in C, the resolvent of D and C subsumes C, so that literal is removed from C ("strengthening").
+	The clauses are processed from the shortest up, each one against the previous ones, so both forward and backward subsumption are covered. 
+	A processed clause is put on one occurrence list only (one-watch), of its literal with the shortest list. 
+	As D shares that literal (or its negation) with C, it is found through the lists of C's literals and their negations. 
+	64-bit signatures of the variables in a clause filter out most candidates. Binary clauses are found through bin_watches.
+	A learned clause never deletes an irredundant one. The budget counts the candidates D that are compared with a clause. 
+	Invoked at level 0; unary clauses that it derives are asserted.
+*/
+SolverState Solver::subsume() {
+	if (verbose_now()) cout << "subsume" << endl;
+	subsume_pending = false;
+	vector<CRef> all;
+	for (vector<CRef>* crefs : { &cnf, &learnts }) 
+		for (CRef cr : *crefs) {
+			Clause& c = ca[cr];
+			if (c.size() <= Subsume_max_size && all_of(c.begin(), c.end(), [this](Lit l) { return lit_state(l) == LitState::L_UNASSIGNED; })) 
+				all.push_back(cr);
+		}
+	stable_sort(all.begin(), all.end(), [this](CRef a, CRef b) { return ca[a].size() < ca[b].size(); });
+	auto signature = [this](CRef cr) {
+		uint64_t sig = 0;
+		for (Lit l : ca[cr]) sig |= 1ull << (l2v(l) & 63);
+		return sig;
+	};
+	vector<uint64_t> sigs(all.size());
+	vector<vector<int>> onewatch(nlits + 1); // Lit => indices into 'all'
+	int subsumed_before = num_subsumed, strengthened_before = num_strengthened;
+	long long steps = 0;
+	clause_t lits;
+	for (size_t i = 0; i < all.size() && steps < subsume_pass.budget; ++i) {
+		CRef cr = all[i];
+		Clause& c = ca[cr];
+		lits.assign(c.begin(), c.end());
+		for (Lit l : lits) lit_seen[l] = true;
+		uint64_t sig = signature(cr);
+		bool subsumed = false;
+		auto strengthen = [&](Lit l) {
+			lits.erase(find(lits.begin(), lits.end(), l));
+			lit_seen[l] = false;
+			++num_strengthened;
+		};
+		for (size_t k = 0; k < lits.size() && !subsumed; ) {
+			Lit l = lits[k];
+			bool removed = false; // a literal was removed from lits
+			Lit flipped = 0; // the literal that a long clause removed
+			// binary clauses (l other) subsume, and (-l other) strengthen.
+			for (Lit other : bin_watches[l]) if (lit_seen[other]) { subsumed = true; break; }
+			for (Lit other : bin_watches[negate_(l)]) 
+				if (!subsumed && lit_seen[other]) { strengthen(l); removed = true; break; }
+			if (removed) continue; // lits[k] is the next literal now
+			for (int s = 0; s < 2 && !subsumed && !removed; ++s) 
+				for (int j : onewatch[s ? negate_(l) : l]) {
+					Clause& d = ca[all[j]];
+					++steps;
+					if (d.is_deleted() || (sigs[j] & ~sig)) continue;
+					Lit flip = 0; // the literal of C whose negation is in D 
+					bool fits = true;
+					for (Lit m : d) {
+						if (lit_seen[m]) continue;
+						if (!flip && lit_seen[negate_(m)]) flip = negate_(m);
+						else { fits = false; break; }
+					}
+					if (!fits) continue;
+					if (!flip) {
+						if (d.is_learnt() && !c.is_learnt()) continue;
+						subsumed = true;
+					}
+					else {
+						strengthen(flip);
+						flipped = flip;
+						removed = true;
+					}
+					break;
+				}
+			if (!removed) ++k;
+			else if (flipped != l) k = find(lits.begin(), lits.end(), l) - lits.begin(); // l is scanned again. If l was removed, lits[k] is the next literal now
+		}
+		for (Lit l : lits) lit_seen[l] = false;
+		if (!c.is_learnt() && (subsumed || lits.size() < c.size())) for (Lit l : c) touch(l);
+		if (subsumed) {
+			ca.free(cr);
+			++num_subsumed;
+			continue;
+		}
+		if (lits.size() < c.size()) { // strengthened
+			if (lits.size() == 1 && lit_state(lits[0]) != LitState::L_UNASSIGNED) { 
+				// assigned by a unary clause derived earlier in this pass. If it is false the formula is unsatisfiable, and C is left for the search to find that.
+				if (lit_state(lits[0]) == LitState::L_SAT) {
+					ca.free(cr);
+					continue;
+				}
+			}
+			else if (lits.size() <= 2) {
+				ca.free(cr);
+				if (lits.size() == 2) add_bin_clause(lits[0], lits[1]);
+				else {
+					add_unary_clause(lits[0]);
+					assert_lit(lits[0]);
+				}
+				continue;
+			}
+			else {
+				copy(lits.begin(), lits.end(), c.begin());
+				ca.shrink(cr, lits.size());
+				c.lw_set(0);
+				c.rw_set(1);
+			}
+		}
+		sigs[i] = signature(cr);
+		Lit best = c.lit(0);
+		for (Lit l : c) if (onewatch[l].size() < onewatch[best].size()) best = l;
+		onewatch[best].push_back(i);
+	}
+	if (num_subsumed == subsumed_before && num_strengthened == strengthened_before) return SolverState::UNDEF;
+	
+	cnf.erase(remove_if(cnf.begin(), cnf.end(), [this](CRef cr) { return ca[cr].is_deleted(); }), cnf.end());
+	learnts.erase(remove_if(learnts.begin(), learnts.end(), [this](CRef cr) { return ca[cr].is_deleted(); }), learnts.end());
+	for (vector<Watcher>& ws : watches) ws.clear();
+	for (vector<CRef>* crefs : { &cnf, &learnts }) 
+		for (CRef cr : *crefs) {
+			Clause& c = ca[cr];
+			watches[c.get_lw_lit()].push_back({ cr, c.get_rw_lit() });
+			watches[c.get_rw_lit()].push_back({ cr, c.get_lw_lit() });
+		}
+	if (ca.wasted() > ca.size() * Garbage_fraction) garbage_collect();
+	if (verbose >= 1) cout << "subsume: " << num_subsumed - subsumed_before << " subsumed, " << num_strengthened - strengthened_before << " literals removed" << endl;
+	return SolverState::UNDEF;
+}
+
+/*
+	Failed-literal probing. Each root of the binary implication graph (a literal that implies others through binary clauses, 
+	but is implied by none) is assigned at level 1 and propagated. If that fails, its negation becomes a unary clause. 
+	Otherwise each literal it implies through a long clause gets the hyper-binary resolvent (-root implied), 
+	so that propagation takes the shortcut next time, unless the binary clauses already imply it from the root. The pass stops when its budget of propagations is used; the next one continues from there. 
+	Invoked at level 0. Returns UNSAT if the formula turns out to be unsatisfiable.
+*/
+SolverState Solver::probe() {
+	if (verbose_now()) cout << "probe" << endl;
+	long long limit = num_propagations + probe_pass.budget;
+	int failed_before = num_failed, hbrs_before = num_hbrs;
+	vector<pair<Lit, Lit>> hbrs;
+	vector<Lit> reached;
+	for (unsigned int count = 0; count < nlits && num_propagations < limit; ++count) {
+		probe_next = probe_next % nlits + 1;
+		Lit l = probe_next;
+		if (!decidable(l2v(l)) || !bin_watches[l].empty() || bin_watches[negate_(l)].empty()) continue; // not a root
+		new_decision_level();
+		assert_lit(l);
+		if (BCP() == SolverState::CONFLICT) {
+			++num_failed;
+			asserted_lit = negate_(l);
+			asserting_clause = CRef_Undef;
+			add_unary_clause(asserted_lit);
+			backtrack(0);
+			if (BCP() == SolverState::UNSAT) return SolverState::UNSAT;
+			continue;
+		}
+		// A literal that the binary clauses (and the resolvents so far) imply from l needs no resolvent. 
+		// The literals reached are true at level 1, so only the level-1 part of the trail is marked.
+		auto reach = [&](Lit from) {
+			lit_seen[from] = true;
+			reached.push_back(from);
+			while (!reached.empty()) {
+				Lit p = reached.back();
+				reached.pop_back();
+				for (Lit q : bin_watches[negate_(p)]) 
+					if (!lit_seen[q] && dlevel[l2v(q)] == 1) {
+						lit_seen[q] = true;
+						reached.push_back(q);
+					}
+			}
+		};
+		reach(l);
+		for (unsigned int i = separators[1] + 1; i < trail.size(); ++i) {
+			Lit u = trail[i];
+			CRef r = antecedent[l2v(u)];
+			if (r != CRef_Undef && !is_bin_ref(r) && dlevel[l2v(u)] == 1 && !lit_seen[u]) {
+				hbrs.push_back({ negate_(l), u });
+				reach(u);
+			}
+		}
+		for (unsigned int i = separators[1]; i < trail.size(); ++i) lit_seen[trail[i]] = false;
+		cancel_until(0);
+		for (auto& b : hbrs) {
+			add_bin_clause(b.first, b.second);
+			touch(b.first);
+			touch(b.second);
+		}
+		num_hbrs += hbrs.size();
+		hbrs.clear();
+	}
+	if (num_hbrs > hbrs_before) subsume_pending = elim_pending = true; // the new binary clauses may subsume, or take part in resolution
+	if (verbose >= 1) cout << "probe: " << num_failed - failed_before << " failed literals, " << num_hbrs - hbrs_before << " hyper-binary resolvents" << endl;
+	return SolverState::UNDEF;
+}
+
+/*
+	Vivification. The literals of a clause C are falsified one by one (each at a new decision level) and propagated, 
+	with C ignored by BCP(), so that it does not imply anything itself. Then:
+	- a literal of C that is implied false is redundant, and removed;
+	- a literal of C that is implied true ends C: the literals tried so far and it form a clause.
+	- a conflict ends C as well: the literals tried so far form a clause.
+	Candidates are the learned clauses of tier 2 and up, the lowest lbd first, and then the irredundant clauses. 
+	Each clause is tried once; the irredundant ones start over when they all were. The budget counts the watchers of the propagated 
+	literals rather than the propagations, as few literals are assigned here, and most clauses that BCP() visits are not satisfied. 
+	Building the candidates is charged to it as well. Invoked at level 0 after simplify(). Returns UNSAT if the formula turns out to be unsatisfiable.
+*/
+SolverState Solver::vivify() {
+	if (verbose_now()) cout << "vivify" << endl;
+	int before = num_vivified;
+	vector<CRef> candidates;
+	for (CRef cr : learnts) {
+		Clause& c = ca[cr];
+		if (c.get_lbd() <= Tier2_lbd && !c.is_vivified()) candidates.push_back(cr);
+	}
+	sort(candidates.begin(), candidates.end(), [this](CRef a, CRef b) { 
+		Clause &ca_ = ca[a], &cb = ca[b];
+		return ca_.get_lbd() < cb.get_lbd() || (ca_.get_lbd() == cb.get_lbd() && ca_.size() < cb.size()); 
+	});
+	size_t nlearnts = candidates.size();
+	for (CRef cr : cnf) if (!ca[cr].is_vivified()) candidates.push_back(cr);
+	if (candidates.size() == nlearnts) 
+		for (CRef cr : cnf) {
+			ca[cr].set_vivified(false);
+			candidates.push_back(cr);
+		}
+	long long steps = learnts.size() + cnf.size() + candidates.size();
+
+	clause_t& kept = new_clause;
+	for (size_t i = 0; i < candidates.size() && steps < vivify_pass.budget; ++i) {
+		CRef cr = candidates[i];
+		Clause& c = ca[cr];
+		c.set_vivified(true);
+		if (any_of(c.begin(), c.end(), [this](Lit l) { return lit_state(l) != LitState::L_UNASSIGNED; })) continue;
+		ignored_clause = cr;
+		kept.clear();
+		for (Lit l : c) {
+			LitState ls = lit_state(l);
+			if (ls == LitState::L_UNSAT) continue; // implied by the negation of kept
+			kept.push_back(l);
+			if (ls == LitState::L_SAT) break;
+			new_decision_level();
+			assert_lit(negate_(l));
+			if (BCP() == SolverState::CONFLICT) break;
+		}
+		for (unsigned int k = separators[1]; k < qhead; ++k) steps += 1 + watches[negate_(trail[k])].size();
+		conflicting_clause = ignored_clause = CRef_Undef; // BCP() must not see the conflict again
+		cancel_until(0);
+		if (kept.size() == c.size() || any_of(kept.begin(), kept.end(), [this](Lit l) { return lit_state(l) != LitState::L_UNASSIGNED; })) 
+			kept.assign(c.begin(), c.end()); // C is left as it is
+		else {
+			++num_vivified;
+			num_vivified_lits += c.size() - kept.size();
+		}
+		if (kept.size() < c.size()) {
+			if (!c.is_learnt()) for (Lit l : c) touch(l);
+			detach(cr);
+			if (kept.size() == 1) {
+				ca.free(cr);
+				add_unary_clause(kept[0]);
+				assert_lit(kept[0]);
+			}
+			else if (kept.size() == 2) {
+				ca.free(cr);
+				add_bin_clause(kept[0], kept[1]);
+			}
+			else {
+				copy(kept.begin(), kept.end(), c.begin());
+				ca.shrink(cr, kept.size());
+				if (c.is_learnt() && c.get_lbd() > static_cast<int>(kept.size())) c.set_lbd(kept.size());
+				c.lw_set(0);
+				c.rw_set(1);
+				watches[c.lit(0)].push_back({ cr, c.lit(1) });
+				watches[c.lit(1)].push_back({ cr, c.lit(0) });
+			}
+		}
+		if (BCP() == SolverState::UNSAT) return SolverState::UNSAT; // the new unary clause, or level-0 literals kept by chronological backtracking
+	}
+	new_clause.clear();
+	if (num_vivified > before) {
+		for (vector<CRef>* crefs : { &cnf, &learnts }) 
+			crefs->erase(remove_if(crefs->begin(), crefs->end(), [this](CRef cr) { return ca[cr].is_deleted(); }), crefs->end());
+		subsume_pending = true;
+		if (ca.wasted() > ca.size() * Garbage_fraction) garbage_collect();
+	}
+	if (verbose >= 1) cout << "vivify: " << num_vivified - before << " clauses strengthened" << endl;
+	return SolverState::UNDEF;
+}
+
+// Removes the watchers of a long clause.
+void Solver::detach(CRef cr) {
+	Clause& c = ca[cr];
+	for (Lit l : { c.get_lw_lit(), c.get_rw_lit() }) {
+		vector<Watcher>& ws = watches[l];
+		ws.erase(find_if(ws.begin(), ws.end(), [cr](const Watcher& w) { return w.cref == cr; }));
+	}
+}
+
+/*
+	Equivalent-literal substitution. The strongly connected components of the binary implication graph (a -> b for each binary clause (-a b))
+	are sets of equivalent literals. They are found with Tarjan's algorithm, and each literal is replaced everywhere by the representative 
+	of its component; the representative of the negated component is the negated representative. A component with both l and -l is UNSAT. 
+	A substituted variable is treated as eliminated, with the clauses (-l r) and (l -r) on elim_stack, so extend_model() gives it the value of 
+	its representative r, and restore() brings it back if it is used again. 
+	Invoked at level 0 after simplify(). Rewriting may make clauses unary, which are asserted here; returns UNSAT if one is empty.
+*/
+SolverState Solver::substitute() {
+	if (verbose_now()) cout << "substitute" << endl;
+	int before = num_substituted;
+	vector<Lit> repr(nlits + 1, 0); // Lit => its representative. 0 if it is not in a component yet.
+	vector<int> index(nlits + 1, -1), low(nlits + 1);
+	vector<Lit> stack, component;
+	vector<pair<Lit, unsigned int> > path; // the DFS path: a literal and the position of its next successor
+	int counter = 0;
+	bool unsat = false;
+	for (Lit root = 1; root <= static_cast<Lit>(nlits) && !unsat; ++root) {
+		if (index[root] >= 0 || !decidable(l2v(root))) continue;
+		index[root] = low[root] = counter++;
+		stack.push_back(root);
+		lit_seen[root] = true; // on the stack
+		path.push_back({ root, 0 });
+		while (!path.empty()) {
+			Lit l = path.back().first;
+			vector<Lit>& succ = bin_watches[negate_(l)]; // the binary clauses (-l s) 
+			if (path.back().second < succ.size()) {
+				Lit s = succ[path.back().second++];
+				if (!decidable(l2v(s))) continue;
+				if (index[s] < 0) {
+					index[s] = low[s] = counter++;
+					stack.push_back(s);
+					lit_seen[s] = true;
+					path.push_back({ s, 0 });
+				}
+				else if (lit_seen[s]) low[l] = min(low[l], index[s]);
+				continue;
+			}
+			path.pop_back();
+			if (!path.empty()) low[path.back().first] = min(low[path.back().first], low[l]);
+			if (low[l] != index[l]) continue;
+			// l is the root of a component
+			component.clear();
+			Lit m;
+			do {
+				m = stack.back();
+				stack.pop_back();
+				lit_seen[m] = false;
+				component.push_back(m);
+			} while (m != l);
+			if (component.size() == 1) {
+				repr[l] = l;
+				continue;
+			}
+			Lit r;
+			if (repr[negate_(l)]) r = negate_(repr[negate_(l)]);
+			else { // a frozen variable is preferred, as it would be restored soon anyway
+				r = component[0];
+				for (Lit c : component) 
+					if (frozen[l2v(c)] > frozen[l2v(r)] || (frozen[l2v(c)] == frozen[l2v(r)] && l2v(c) < l2v(r))) r = c;
+			}
+			for (Lit c : component) {
+				if (marked[l2v(c)]) unsat = true;
+				marked[l2v(c)] = true;
+				repr[c] = r;
+			}
+			for (Lit c : component) marked[l2v(c)] = false;
+			if (unsat) break;
+		}
+	}
+	for (Lit l : stack) lit_seen[l] = false;
+	if (unsat) {
+		if (verbose >= 1) cout << "substitute: a literal is equivalent to its negation" << endl;
+		inconsistent = true;
+		return SolverState::UNSAT;
+	}
+	// A frozen variable (an assumption) stays. It is then the representative of its component, 
+	// or one of several frozen ones whose binary clauses, rewritten, still keep it equivalent to the representative.
+	for (Lit l = 1; l <= static_cast<Lit>(nlits); ++l) if (frozen[l2v(l)]) repr[l] = l;
+	for (unsigned int v = 1; v <= nvars; ++v) {
+		Lit l = v2l(v);
+		if (!repr[l] || repr[l] == l) continue;
+		for (Lit x : { l, negate_(l) }) { // (x -r(x))
+			elim_stack.push_back(2);
+			elim_stack.push_back(x);
+			elim_stack.push_back(negate_(repr[x]));
+		}
+		eliminated[v] = true;
+		++num_substituted;
+	}
+	substituted_bins = nbins;
+	if (num_substituted == before) return SolverState::UNDEF;
+	for (Lit l = 1; l <= static_cast<Lit>(nlits); ++l) if (!repr[l]) repr[l] = l;
+	for (Lit& l : unaries) l = repr[l]; // unaries are assigned, so this is only for completeness
+
+	// Rewrites c, and drops its false and duplicate literals. Returns false if it is satisfied (or a tautology).
+	auto rewrite = [&](clause_t& c) {
+		size_t j = 0;
+		bool satisfied = false;
+		for (Lit l : c) {
+			l = repr[l];
+			LitState ls = lit_state(l);
+			if (ls == LitState::L_SAT || lit_seen[negate_(l)]) { satisfied = true; break; }
+			if (ls == LitState::L_UNSAT || lit_seen[l]) continue;
+			lit_seen[l] = true;
+			c[j++] = l;
+		}
+		for (size_t i = 0; i < j; ++i) lit_seen[c[i]] = false;
+		c.resize(j);
+		return !satisfied;
+	};
+	// Adds a rewritten clause that is not long. Returns false if it is empty.
+	vector<pair<Lit, Lit> > bins;
+	auto add_short = [&](const clause_t& c) {
+		if (c.empty()) return false;
+		if (c.size() == 1) {
+			add_unary_clause(c[0]);
+			assert_lit(c[0]);
+		}
+		else bins.push_back({ min(c[0], c[1]), max(c[0], c[1]) });
+		return true;
+	};
+
+	clause_t c;
+	for (Lit l = 1; l <= static_cast<Lit>(nlits); ++l) 
+		for (Lit other : bin_watches[l]) 
+			if (l < other) bins.push_back({ l, other });
+	for (vector<Lit>& ws : bin_watches) ws.clear();
+	nbins = 0;
+	size_t nold = bins.size();
+	for (size_t i = 0; i < nold && !unsat; ++i) {
+		c = { bins[i].first, bins[i].second };
+		if (rewrite(c)) unsat = !add_short(c);
+	}
+	bins.erase(bins.begin(), bins.begin() + nold);
+	for (vector<CRef>* crefs : { &cnf, &learnts }) {
+		size_t j = 0;
+		for (CRef cr : *crefs) {
+			Clause& cl = ca[cr];
+			if (unsat || none_of(cl.begin(), cl.end(), [&](Lit l) { return repr[l] != l; })) {
+				(*crefs)[j++] = cr;
+				continue;
+			}
+			c.assign(cl.begin(), cl.end());
+			if (!rewrite(c)) { ca.free(cr); continue; }
+			if (c.size() < 3) {
+				unsat = !add_short(c);
+				ca.free(cr);
+				continue;
+			}
+			copy(c.begin(), c.end(), cl.begin());
+			if (c.size() < cl.size()) ca.shrink(cr, c.size());
+			cl.lw_set(0);
+			cl.rw_set(1);
+			(*crefs)[j++] = cr;
+		}
+		crefs->resize(j);
+	}
+	sort(bins.begin(), bins.end());
+	bins.erase(unique(bins.begin(), bins.end()), bins.end());
+	for (auto& b : bins) add_bin_clause(b.first, b.second);
+	for (vector<Watcher>& ws : watches) ws.clear();
+	for (vector<CRef>* crefs : { &cnf, &learnts }) 
+		for (CRef cr : *crefs) {
+			Clause& cl = ca[cr];
+			watches[cl.get_lw_lit()].push_back({ cr, cl.get_rw_lit() });
+			watches[cl.get_rw_lit()].push_back({ cr, cl.get_lw_lit() });
+		}
+	substituted_bins = nbins;
+	elim_pending = subsume_pending = true;
+	fill(elim_touched.begin(), elim_touched.end(), true); // the clauses of the representatives changed
+	if (ca.wasted() > ca.size() * Garbage_fraction) garbage_collect();
+	if (verbose >= 1) cout << "substitute: " << num_substituted - before << " variables substituted, " << cnf_size() << " clauses left" << endl;
+	if (unsat) inconsistent = true;
+	return unsat ? SolverState::UNSAT : SolverState::UNDEF;
+}
+
+/*
+	Bounded variable elimination: a variable v is replaced by all the resolvents on it of its clauses, 
+	as long as that does not increase the number of clauses. The removed clauses are kept on elim_stack, 
+	for extend_model() to assign v after the rest of the formula is satisfied. 
+	Invoked at level 0 after simplify(), so all the clause literals are unassigned. Learned clauses with eliminated variables are deleted. 
+	Only the variables whose irredundant clauses changed since the last try are candidates (elim_touched), so that a pass that ran 
+	out of budget is continued by the next one rather than repeated. The budget counts the resolutions tried.
+*/
+SolverState Solver::eliminate() {
+	if (verbose_now()) cout << "eliminate" << endl;
+	vector<vector<CRef>> occurs(nlits + 1); // Lit => the irredundant long clauses it is in
+	for (CRef cr : cnf) 
+		for (Lit l : ca[cr]) occurs[l].push_back(cr);
+	auto occ_count = [&](Lit l) { return occurs[l].size() + bin_watches[l].size(); };
+	vector<Var> candidates;
+	for (unsigned int v = 1; v <= nvars; ++v) {
+		if (!elim_touched[v]) continue;
+		if (decidable(v) && !frozen[v] && occ_count(v2l(v)) + occ_count(v2l(-v)) > 0) candidates.push_back(v);
+		else elim_touched[v] = false; // touched again when it is unfrozen, restored, or gets clauses
+	}
+	sort(candidates.begin(), candidates.end(), [&](Var a, Var b) { 
+		return occ_count(v2l(a)) * occ_count(v2l(-a)) < occ_count(v2l(b)) * occ_count(v2l(-b)); 
+	});
+
+	int before = num_eliminated;
+	long long resolutions = 0;
+	vector<clause_t> side[2], resolvents;
+	clause_t resolvent;
+	bool complete = true; // every candidate was tried
+	for (Var v : candidates) {
+		Lit pos = v2l(v), neg = v2l(-v);
+		if (resolutions >= elim_pass.budget) {
+			complete = false;
+			break;
+		}
+		elim_touched[v] = false;
+		if (occ_count(pos) * occ_count(neg) > Elim_max_resolutions) continue;
+		// the clauses of v, with v's literal first.
+		for (int s = 0; s < 2; ++s) {
+			Lit x = s ? neg : pos;
+			side[s].clear();
+			for (CRef cr : occurs[x]) {
+				Clause& c = ca[cr];
+				if (c.is_deleted()) continue;
+				side[s].push_back({ x });
+				for (Lit l : c) if (l != x) side[s].back().push_back(l);
+			}
+			for (Lit other : bin_watches[x]) side[s].push_back({ x, other });
+		}
+		resolvents.clear();
+		bool bounded = true;
+		for (clause_t& p : side[0]) {
+			for (clause_t& n : side[1]) {
+				++resolutions;
+				if (!resolve(p, n, resolvent)) continue; // a tautology
+				if (resolvents.size() == side[0].size() + side[1].size() || resolvent.size() < 2 || resolvent.size() > Elim_max_resolvent) {
+					bounded = false;
+					break;
+				}
+				resolvents.push_back(resolvent);
+			}
+			if (!bounded) break;
+		}
+		if (!bounded) continue;
+
+		// v is eliminated: its clauses move to elim_stack, and the resolvents replace them.
+		for (int s = 0; s < 2; ++s) {
+			Lit x = s ? neg : pos;
+			for (clause_t& c : side[s]) {
+				elim_stack.push_back(c.size());
+				elim_stack.insert(elim_stack.end(), c.begin(), c.end());
+				for (Lit l : c) touch(l); // the variables that were tried before may be eliminable now
+			}
+			for (CRef cr : occurs[x]) if (!ca[cr].is_deleted()) ca.free(cr);
+			occurs[x].clear();
+			for (Lit other : bin_watches[x]) {
+				vector<Lit>& ws = bin_watches[other];
+				ws.erase(find(ws.begin(), ws.end(), x));
+				--nbins;
+			}
+			bin_watches[x].clear();
+		}
+		for (clause_t& r : resolvents) {
+			CRef cr = add_clause(r, 0, 1);
+			if (cr != CRef_Undef) for (Lit l : r) occurs[l].push_back(cr);
+		}
+		eliminated[v] = true;
+		++num_eliminated;
+	}
+	elim_pending = false;
+	elim_incomplete = !complete;
+	if (num_eliminated == before) return SolverState::UNDEF;
+
+	cnf.erase(remove_if(cnf.begin(), cnf.end(), [this](CRef cr) { return ca[cr].is_deleted(); }), cnf.end());
+	learnts.erase(remove_if(learnts.begin(), learnts.end(), [this](CRef cr) { 
+		Clause& c = ca[cr];
+		for (Lit l : c) 
+			if (eliminated[l2v(l)]) {
+				ca.free(cr);
+				return true;
+			}
+		return false; 
+	}), learnts.end());
+	for (vector<Watcher>& ws : watches) 
+		ws.erase(remove_if(ws.begin(), ws.end(), [this](const Watcher& w) { return ca[w.cref].is_deleted(); }), ws.end());
+	if (ca.wasted() > ca.size() * Garbage_fraction) garbage_collect();
+	if (verbose >= 1) cout << "eliminate: " << num_eliminated - before << " variables eliminated, " << cnf_size() << " clauses left" << endl;
+	return SolverState::UNDEF;
+}
+
+// The resolvent of p and n on their first literal. Returns false if it is a tautology.
+bool Solver::resolve(const clause_t& p, const clause_t& n, clause_t& out) {
+	out.clear();
+	for (size_t i = 1; i < p.size(); ++i) {
+		lit_seen[p[i]] = true;
+		out.push_back(p[i]);
+	}
+	bool tautology = false;
+	for (size_t i = 1; i < n.size() && !tautology; ++i) {
+		if (lit_seen[negate_(n[i])]) tautology = true;
+		else if (!lit_seen[n[i]]) out.push_back(n[i]);
+	}
+	for (size_t i = 1; i < p.size(); ++i) lit_seen[p[i]] = false;
+	return !tautology;
+}
+
+// Assigns the eliminated variables, once the rest are assigned. In the reverse order of elimination, 
+// each variable is flipped to satisfy the clauses of it that are not satisfied otherwise. 
+void Solver::extend_model() {
+	vector<size_t> starts;
+	for (size_t i = 0; i < elim_stack.size(); i += elim_stack[i] + 1) starts.push_back(i);
+	for (unsigned int v = 1; v <= nvars; ++v) 
+		if (eliminated[v]) {
+			state[v] = VarState::V_FALSE;
+			lit_val[v2l(v)] = static_cast<int8_t>(LitState::L_UNSAT);
+			lit_val[v2l(-v)] = static_cast<int8_t>(LitState::L_SAT);
+		}
+	for (auto it = starts.rbegin(); it != starts.rend(); ++it) {
+		Lit* c = &elim_stack[*it + 1];
+		Lit* end = c + elim_stack[*it];
+		if (any_of(c, end, [this](Lit l) { return lit_state(l) == LitState::L_SAT; })) continue;
+		Var v = l2v(c[0]);
+		state[v] = Neg(c[0]) ? VarState::V_FALSE : VarState::V_TRUE;
+		lit_val[c[0]] = static_cast<int8_t>(LitState::L_SAT);
+		lit_val[negate_(c[0])] = static_cast<int8_t>(LitState::L_UNSAT);
+	}
+}
+
+// Unassigns the eliminated variables, which extend_model() assigned off the trail.
+void Solver::unextend_model() {
+	for (unsigned int v = 1; v <= nvars; ++v) 
+		if (eliminated[v] && state[v] != VarState::V_UNASSIGNED) unassign(v);
+}
+
+// Brings an eliminated variable back, with its clauses, because it is used again (added or assumed).
+void Solver::restore(Var v) {
+	if (!eliminated[v]) return;
+	eliminated[v] = false;
+	vector<clause_t> clauses;
+	size_t j = 0;
+	for (size_t i = 0; i < elim_stack.size(); ) {
+		size_t size = elim_stack[i];
+		if (l2v(elim_stack[i + 1]) == v) clauses.push_back(clause_t(&elim_stack[i + 1], &elim_stack[i + 1] + size));
+		else for (size_t k = i; k <= i + size; ++k) elim_stack[j++] = elim_stack[k];
+		i += size + 1;
+	}
+	elim_stack.resize(j);
+	for (clause_t& c : clauses) {
+		for (Lit l : c) restore(l2v(l)); // variables that were eliminated after v
+		add_input_clause(c);
+	}
+	if (uses_heap() && !heap_contains(v)) heap_insert(v);
+	if (VarDecHeuristic == VAR_DEC_HEURISTIC::VMTF && vmtf_stamp[v] > vmtf_stamp[vmtf_search]) vmtf_search = v;
+}
+
+/*
+	Is the (false) literal p of the learned clause implied by the other literals of the clause?
+	A DFS over the antecedents: p is redundant if every path back from it ends in marked (clause) literals or at level 0. 
+	Abstract levels prune the search: a literal from a decision level that no clause literal has cannot be implied by them. 
+	The results are cached in min_state, so each variable is explored once per analyze().
+*/
+bool Solver::lit_redundant(Lit p, unsigned int abstract_levels) {
+	min_stack.clear();
+	int i = 0;
+	while (true) {
+		CRef r = antecedent[l2v(p)];
+		int size = is_bin_ref(r) ? 1 : ca[r].size();
+		if (i < size) {
+			Lit l = is_bin_ref(r) ? bin_ref_lit(r) : ca[r].lit(i);
+			++i;
+			Var v = l2v(l);
+			if (v == l2v(p) || marked[v] || dlevel[v] == 0 || min_state[v] == MinState::REMOVABLE) continue;
+			if (antecedent[v] == CRef_Undef || min_state[v] == MinState::POISONED || !(abstract_level(v) & abstract_levels)) {
+				// Neither p nor anything on the way to it can be removed.
+				min_stack.push_back({ p, i });
+				for (auto& e : min_stack) {
+					Var w = l2v(e.first);
+					if (!marked[w] && min_state[w] == MinState::UNKNOWN) {
+						min_state[w] = MinState::POISONED;
+						min_to_clear.push_back(w);
+					}
+				}
+				return false;
+			}
+			min_stack.push_back({ p, i });
+			p = l;
+			i = 0;
+		}
+		else { // all of p's antecedent is implied.
+			Var v = l2v(p);
+			if (!marked[v] && min_state[v] == MinState::UNKNOWN) {
+				min_state[v] = MinState::REMOVABLE;
+				min_to_clear.push_back(v);
+			}
+			if (min_stack.empty()) return true;
+			p = min_stack.back().first;
+			i = min_stack.back().second;
+			min_stack.pop_back();
+		}
+	}
+}
+
 /*******************************************************************************************************************
 name: analyze
 input:	1) conflicting clause
@@ -465,83 +1569,119 @@ assumes: 1) no clause should have the same literal twice. To guarantee this we r
 This is Alg. 1 from "HaifaSat: a SAT solver based on an Abstraction/Refinement model" 
 ********************************************************************************************************************/
 
-int Solver::analyze(const Clause& conflicting) {
+int Solver::analyze(CRef conflicting) {
 	if (verbose_now()) cout << "analyze" << endl;
-	Clause	current_clause = conflicting, 
-			new_clause;
+	// new_clause is a member, so that its memory is reused across conflicts. Antecedents are read in place.
+	new_clause.clear();
 	int resolve_num = 0,
 		bktrk = 0, 
-		watch_lit = 0, // points to what literal in the learnt clause should be watched, other than the asserting one
-		antecedents_idx = 0;
+		watch_lit = 0; // points to what literal in the learnt clause should be watched, other than the asserting one
 
-	Lit u;
+	Lit u = 0; // the pivot: the literal whose antecedent is resolved. 0 while processing the conflicting clause.
 	Var v;
+	auto analyze_lit = [&](Lit lit) {
+		Var w = l2v(lit);
+		if (marked[w] || dlevel[w] == 0) return; // level-0 literals are false for good, so the learned clause does without them
+		marked[w] = true;
+		if (VarDecHeuristic == VAR_DEC_HEURISTIC::VMTF) vmtf_analyzed.push_back(w);
+		if (VarDecHeuristic == VAR_DEC_HEURISTIC::LRB) ++lrb_participated[w];
+		if (dlevel[w] == dl) ++resolve_num;
+		else { // literals from previous decision levels (roots) are entered to the learned clause.
+			new_clause.push_back(lit);
+			if (VarDecHeuristic == VAR_DEC_HEURISTIC::MINISAT) bumpVarScore(w);
+			if (ValDecHeuristic == VAL_DEC_HEURISTIC::LITSCORE) bumpLitScore(lit);
+		}
+	};
+	CRef reason = conflicting;
 	trail_t::reverse_iterator t_it = trail.rbegin();
 	do {
-		for (clause_it it = current_clause.cl().begin(); it != current_clause.cl().end(); ++it) {
-			Lit lit = *it;
-			v = l2v(lit);
-			if (!marked[v]) {
-				marked[v] = true;
-				if (dlevel[v] == dl) ++resolve_num;
-				else { // literals from previous decision levels (roots) are entered to the learned clause.
-					new_clause.insert(lit);
-					if (VarDecHeuristic == VAR_DEC_HEURISTIC::MINISAT) bumpVarScore(v);
-					if (ValDecHeuristic == VAL_DEC_HEURISTIC::LITSCORE) bumpLitScore(lit);
-					int c_dl = dlevel[v];
-					if (c_dl > bktrk) {
-						bktrk = c_dl;
-						watch_lit = new_clause.size() - 1;
-					}
-				}
-			}
-		} 
+		Assert(reason != CRef_Undef);
+		if (is_bin_ref(reason)) {
+			analyze_lit(bin_ref_lit(reason));
+			if (!u) analyze_lit(conflicting_lit); // a conflicting binary clause: both of its literals.
+		}
+		else {
+			bump_clause(reason);
+			for (Lit lit : ca[reason]) 
+				if (l2v(lit) != l2v(u)) analyze_lit(lit); // the antecedent without the pivot.
+		}
 		
 		while (t_it != trail.rend()) {
 			u = *t_it;
 			v = l2v(u);
 			++t_it;
-			if (marked[v]) break;
+			if (marked[v] && dlevel[v] == dl) break; // with chronological backtracking, marked literals of lower levels may come later on the trail.
 		}
 		marked[v] = false;
 		--resolve_num;
-		if(!resolve_num) continue; 
-		int ant = antecedent[v];		
-        Assert(0 <= ant && ant < cnf.size());
-		current_clause = cnf[ant]; 
-        // TODO: Should we remove u or negate_(u)?
-        auto f = find(current_clause.cl().begin(), current_clause.cl().end(), u);
-        if (f != current_clause.cl().end()) current_clause.cl().erase(f);	
+		reason = antecedent[v];		
 	}	while (resolve_num > 0);
-	for (clause_it it = new_clause.cl().begin(); it != new_clause.cl().end(); ++it) 
+
+	// Recursive minimization: removing the literals that are implied by the other literals of the clause.
+	unsigned int abstract_levels = 0;
+	for (Lit l : new_clause) abstract_levels |= abstract_level(l2v(l));
+	size_t kept = 0;
+	for (size_t i = 0; i < new_clause.size(); ++i) {
+		Lit l = new_clause[i];
+		if (antecedent[l2v(l)] == CRef_Undef || !lit_redundant(l, abstract_levels)) new_clause[kept++] = l;
+		else min_to_clear.push_back(l2v(l)); // to be unmarked below
+	}
+	num_minimized += new_clause.size() - kept;
+	new_clause.resize(kept);
+	bktrk = 0;
+	for (size_t i = 0; i < new_clause.size(); ++i) 
+		if (dlevel[l2v(new_clause[i])] > bktrk) {
+			bktrk = dlevel[l2v(new_clause[i])];
+			watch_lit = i;
+		}
+	for (Var w : min_to_clear) {
+		min_state[w] = MinState::UNKNOWN;
+		marked[w] = false;
+	}
+	min_to_clear.clear();
+
+	if (VarDecHeuristic == VAR_DEC_HEURISTIC::LRB) {
+		lrb_bump_reasons(new_clause); // before unmarking: the clause's own variables are skipped.
+		lrb_step = max(Lrb_step_min, lrb_step - Lrb_step_decrement);
+	}
+	for (clause_it it = new_clause.begin(); it != new_clause.end(); ++it) 
 		marked[l2v(*it)] = false;
 	Lit Negated_u = negate_(u);
-	new_clause.cl().push_back(Negated_u);		
+	new_clause.push_back(Negated_u);		
 	if (VarDecHeuristic == VAR_DEC_HEURISTIC::MINISAT) 
 		m_var_inc *= 1 / var_decay; // increasing importance of participating variables.
+	if (VarDecHeuristic == VAR_DEC_HEURISTIC::VMTF) vmtf_bump_analyzed();
 	
 	++num_learned;
+	int lbd = compute_lbd(new_clause.begin(), new_clause.end());
+	update_restart_stats(lbd);
 	asserted_lit = Negated_u;
 	if (new_clause.size() == 1) { // unary clause	
 		add_unary_clause(Negated_u);
+		asserting_clause = CRef_Undef;
+	}
+	else if (new_clause.size() == 2) {
+		add_bin_clause(new_clause[watch_lit], Negated_u);
+		asserting_clause = bin_ref(new_clause[watch_lit]);
 	}
 	else {
-		add_clause(new_clause, watch_lit, new_clause.size() - 1);
+		asserting_clause = add_clause(new_clause, watch_lit, new_clause.size() - 1, true);
+		Clause& c = ca[asserting_clause];
+		c.set_lbd(lbd);
+		c.set_used(1);
 	}
-    if (learn_callback && new_clause.size() <= learn_callback_max_length) {
+    if (learn_callback && static_cast<int>(new_clause.size()) <= learn_callback_max_length) {
         // null terminated `new_clause`, with literals in cnf-like form.
-        vector<int> c;
-        c.resize(new_clause.size() + 1);
-        for (size_t i = 0; i < c.size(); i++) {
-            c[i] = i == new_clause.size() ? 0 : l2rl(new_clause.lit(i));
-        }
-        learn_callback(learn_callback_state, c.data());
+        learn_callback_buffer.clear();
+        for (Lit l : new_clause) learn_callback_buffer.push_back(l2rl(l));
+        learn_callback_buffer.push_back(0);
+        learn_callback(learn_callback_state, learn_callback_buffer.data());
     }
 	
 
 	if (verbose_now()) {	
 		cout << "Learned clause #" << cnf_size() + unaries.size() << ". "; 
-		new_clause.print_real_lits(); 
+		print_real_lits(new_clause); 
 		cout << endl;
 		cout << " learnt clauses:  " << num_learned;				
 		cout << " Backtracking to level " << bktrk << endl;
@@ -553,51 +1693,136 @@ int Solver::analyze(const Clause& conflicting) {
 	return bktrk; 
 }
 
+/*
+	Called when the assumption p is false, before any normal decision: all the decisions on the trail are assumptions.
+	Collects into failed the assumptions that ~p follows from, by going back on the trail from ~p through the antecedents.
+	With chronological backtracking the trail is not sorted by level, but an antecedent is always earlier on the trail than what it implied.
+*/
+void Solver::analyze_final(Lit p) {
+	if (verbose_now()) cout << "analyze_final" << endl;
+	clause_t core = { p };
+	if (dlevel[l2v(p)] > 0) {
+		marked[l2v(p)] = true;
+		for (int i = trail.size() - 1; i >= separators[1]; --i) {
+			Lit u = trail[i];
+			Var v = l2v(u);
+			if (!marked[v]) continue;
+			marked[v] = false;
+			CRef r = antecedent[v];
+			if (r == CRef_Undef) core.push_back(u); // a decision, i.e. an assumption
+			else if (is_bin_ref(r)) {
+				Var w = l2v(bin_ref_lit(r));
+				if (dlevel[w] > 0) marked[w] = true;
+			}
+			else for (Lit l : ca[r]) 
+				if (l2v(l) != v && dlevel[l2v(l)] > 0) marked[l2v(l)] = true;
+		}
+	}
+	set_failed(core);
+	if (verbose_now()) { cout << "failed assumptions: "; print_real_lits(failed); cout << endl; }
+}
+
+void Solver::set_failed(const vector<Lit>& lits) {
+	for (Lit l : failed) failed_lit[l] = false;
+	failed.clear();
+	for (Lit l : lits) 
+		if (!failed_lit[l]) {
+			failed_lit[l] = true;
+			failed.push_back(l);
+		}
+}
+
 void Solver::backtrack(int k) {
 	if (verbose_now()) cout << "backtrack" << endl;
-	// local restart means that we restart if the number of conflicts learned in this 
-	// decision level has passed the threshold. 
-	if (k > 0 && (num_learned - conflicts_at_dl[k] > restart_threshold)) {	// "local restart"	
-		restart(); 		
-		return;
+	// chronological backtracking: after a long jump, most of the undone levels would be redone. So only the last one is undone, 
+	// and the asserted literal joins the trail out of order, with level k.
+	int level = (chrono && k > 0 && dl - k > Chrono_min_jump) ? dl - 1 : k;
+	if (level != k) ++num_chrono_backtracks;
+	conflicting_clause = CRef_Undef; // analyzed
+	cancel_until(level);
+	if (level > 0 && restart_due(level)) {
+		int reused = passes_due() ? 0 : reusable_levels(level); // the passes run at level 0
+		restart(reused);
+		if (reused < k) return; 
+		// all of the trail would be rebuilt as it is, so the restart amounts to the regular backtrack.
 	}
-	static int counter = 0;
-		
-	for (trail_t::iterator it = trail.begin() + separators[k+1]; it != trail.end(); ++it) { // erasing from k+1
+	assert_lit(asserted_lit, asserting_clause);
+}
+
+void Solver::cancel_until(int k) {
+	trail_t::iterator kept = trail.begin() + separators[k+1];
+	for (trail_t::iterator it = kept; it != trail.end(); ++it) { // erasing from k+1
 		Var v = l2v(*it);
-		if (dlevel[v]) { // we need the condition because of learnt unary clauses. In that case we enforce an assignment with dlevel = 0.
-			state[v] = VarState::V_UNASSIGNED;
-			if (VarDecHeuristic == VAR_DEC_HEURISTIC::MINISAT) m_curr_activity = max(m_curr_activity, m_activity[v]);
-		}
+		if (dlevel[v] > k) unassign(v);
+		// learnt unary clauses (level 0), and with chronological backtracking any literal of a level up to k, may appear after separators[k+1].
+		else *kept++ = *it;
 	}
-	if (VarDecHeuristic == VAR_DEC_HEURISTIC::MINISAT) m_should_reset_iterators = true;
 	if (verbose_now()) print_state();
-	trail.erase(trail.begin() + separators[k+1], trail.end());
-	qhead = trail.size();
+	trail.erase(kept, trail.end());
+	qhead = separators[k+1]; // the kept literals are propagated again, as the undone assignments may have moved their watches.
 	dl = k;	
-	assert_lit(asserted_lit);
-	antecedent[l2v(asserted_lit)] = cnf.size() - 1;
-	conflicting_clause_idx = -1;
+}
+
+// With chronological backtracking, the conflicting clause may have no literal at dl. In that case we backtrack to its highest level, 
+// where analyze() resolves it as usual. Returns that level (0 means the formula is unsatisfiable). 
+int Solver::conflict_level() {
+	int level = 0;
+	if (is_bin_ref(conflicting_clause)) 
+		level = max(dlevel[l2v(bin_ref_lit(conflicting_clause))], dlevel[l2v(conflicting_lit)]);
+	else for (Lit l : ca[conflicting_clause]) level = max(level, dlevel[l2v(l)]);
+	if (level == 0) conflicting_clause = CRef_Undef;
+	else if (level < dl) cancel_until(level);
+	return level;
+}
+
+// Trail reuse: the decisions that the heuristic prefers to the next one would be taken again, in the same order, after a restart. 
+// So the levels (up to k) of those decisions are kept. Invoked after backtracking to k.
+int Solver::reusable_levels(int k) {
+	Var next = 0;
+	if (uses_heap()) {
+		while (!m_heap.empty() && !decidable(m_heap[0])) heap_remove_max();
+		if (m_heap.empty()) return k;
+		next = m_heap[0];
+	}
+	else if (VarDecHeuristic == VAR_DEC_HEURISTIC::VMTF) {
+		while (vmtf_search && !decidable(vmtf_search)) vmtf_search = vmtf_prev[vmtf_search];
+		if (!vmtf_search) return k;
+		next = vmtf_search;
+	}
+	int reused = min(k, static_cast<int>(assumptions.size())); // the levels of the assumptions are always kept
+	while (reused < k) {
+		Var d = l2v(trail[separators[reused + 1]]); // the decision of level reused + 1
+		if (uses_heap() ? m_activity[d] <= m_activity[next] : vmtf_stamp[d] <= vmtf_stamp[next]) break;
+		++reused;
+	}
+	return reused;
 }
 
 void Solver::validate_assignment() {
 	for (unsigned int i = 1; i <= nvars; ++i) if (state[i] == VarState::V_UNASSIGNED) {
 		cout << "Unassigned var: " + to_string(i) << endl; // This is supposed to happen only if the variable does not appear in any clause
 	}
-	for (vector<Clause>::iterator it = cnf.begin(); it != cnf.end(); ++it) {
+	for (vector<CRef>::iterator it = cnf.begin(); it != cnf.end(); ++it) {
+		Clause& c = ca[*it];
 		int found = 0;
-		for(clause_it it_c = it->cl().begin(); it_c != it->cl().end() && !found; ++it_c) 
+		for(Lit* it_c = c.begin(); it_c != c.end() && !found; ++it_c) 
 			if (lit_state(*it_c) == LitState::L_SAT) found = 1;
 		if (!found) {
 			cout << "fail on clause: "; 
-			it->print();
+			c.print();
 			cout << endl;
-			for (clause_it it_c = it->cl().begin(); it_c != it->cl().end() && !found; ++it_c)
+			for (Lit* it_c = c.begin(); it_c != c.end() && !found; ++it_c)
 				cout << *it_c << " (" << (int) lit_state(*it_c) << ") ";
 			cout << endl;
 			Abort("Assignment validation failed", 3);
 		}
 	}
+	for (Lit l = 1; l <= static_cast<Lit>(nlits); ++l) 
+		for (Lit other : bin_watches[l]) 
+			if (lit_state(l) != LitState::L_SAT && lit_state(other) != LitState::L_SAT) {
+				cout << "fail on binary clause: " << l << " " << other << endl;
+				Abort("Assignment validation failed", 3);
+			}
 	for (vector<Lit>::iterator it = unaries.begin(); it != unaries.end(); ++it) {
 		if (lit_state(*it) != LitState::L_SAT) 
 			Abort("Assignment validation failed (unaries)", 3);
@@ -605,29 +1830,123 @@ void Solver::validate_assignment() {
 	cout << "Assignment validated" << endl;
 }
 
-void Solver::restart() {	
+// called on every learned clause, while the trail still holds the conflicting assignment.
+void Solver::update_restart_stats(int lbd) {
+	if (RestartPolicy != RESTART_POLICY::GLUCOSE && RestartPolicy != RESTART_POLICY::SWITCHING) return;
+	lbd_fast.update(lbd);
+	lbd_slow.update(lbd);
+	// a trail that is much larger than usual suggests we are close to a satisfying assignment: postpone the next restart.
+	if (!stable && num_learned > Glucose_block_after && num_learned - last_restart >= Glucose_min_conflicts && 
+		trail.size() > Glucose_R * trail_avg.value) {
+		last_restart = num_learned;
+		++num_blocked_restarts;
+		if (verbose >= 1) cout << "restart blocked" << endl;
+	}
+	trail_avg.update(trail.size());
+}
+
+// the x'th element (from 0) of the Luby sequence 1,1,2,1,1,2,4,1,1,2,... Taken from minisat.
+static int luby(int x) {
+	int size = 1, seq;
+	for (seq = 0; size < x + 1; ++seq) size = 2 * size + 1;
+	while (size - 1 != x) {
+		size = (size - 1) >> 1;
+		--seq;
+		x = x % size;
+	}
+	return 1 << seq;
+}
+
+void Solver::switch_mode() {
+	stable = !stable;
+	mode_budget *= Mode_growth;
+	mode_switch_at = num_learned + mode_budget;
+	luby_index = 0;
+	++num_mode_switches;
+	if (verbose >= 1) cout << "switching to " << (stable ? "stable" : "focused") << " mode for " << mode_budget << " conflicts" << endl;
+}
+
+bool Solver::restart_due(int k) {
+	bool luby_due = num_learned - last_restart >= Luby_unit * luby(luby_index),
+		glucose_due = num_learned - last_restart >= Glucose_min_conflicts && lbd_fast.value * Glucose_K > lbd_slow.value;
+	switch (RestartPolicy) {
+	case RESTART_POLICY::LOCAL:
+		// local restart means that we restart if the number of conflicts learned in this 
+		// decision level has passed the threshold. 
+		return num_learned - conflicts_at_dl[k] > restart_threshold;
+	case RESTART_POLICY::GLUCOSE:
+		return glucose_due;
+	case RESTART_POLICY::LUBY:
+		return luby_due;
+	case RESTART_POLICY::SWITCHING:
+		if (num_learned >= mode_switch_at) return true; // restart() switches the mode
+		return stable ? luby_due : glucose_due;
+	}
+	return false;
+}
+
+// Invoked on a conflict. The levels below the conflicting one were propagated without a conflict. 
+void Solver::update_target_phases() {
+	unsigned int size = separators[dl];
+	if (size > target_size) {
+		target_size = size;
+		for (unsigned int i = 0; i < size; ++i) target_phase[l2v(trail[i])] = state[l2v(trail[i])];
+	}
+	if (size > best_size) {
+		best_size = size;
+		for (unsigned int i = 0; i < size; ++i) best_phase[l2v(trail[i])] = state[l2v(trail[i])];
+	}
+}
+
+// Resets the saved phases, to escape the part of the search space that they keep us in. 
+void Solver::rephase() {
+	static const Phase schedule[] = { Phase::ORIGINAL, Phase::BEST, Phase::INVERTED, Phase::BEST, Phase::RANDOM, Phase::BEST };
+	Phase phase = schedule[num_rephases % (sizeof(schedule) / sizeof(schedule[0]))];
+	for (unsigned int v = 1; v <= nvars; ++v) 
+		switch (phase) {
+		case Phase::ORIGINAL: prev_state[v] = VarState::V_FALSE; break;
+		case Phase::INVERTED: prev_state[v] = VarState::V_TRUE; break;
+		case Phase::BEST: if (best_phase[v] != VarState::V_UNASSIGNED) prev_state[v] = best_phase[v]; break;
+		case Phase::RANDOM: 
+			rand_seed = rand_seed * 1103515245 + 12345;
+			prev_state[v] = (rand_seed >> 16) & 1 ? VarState::V_TRUE : VarState::V_FALSE; 
+			break;
+		}
+	fill(target_phase.begin(), target_phase.end(), VarState::V_UNASSIGNED); 
+	target_size = 0;
+	if (phase == Phase::BEST) best_size = 0; // look for a new best from here
+	++num_rephases;
+	next_rephase = num_learned + Rephase_first + Rephase_increment * num_rephases;
+	if (verbose >= 1) cout << "rephase #" << num_rephases << endl;
+}
+
+// reused: # decision levels that are kept (see reusable_levels()). 0 for a full restart.
+void Solver::restart(int reused) {	
 	if (verbose_now()) cout << "restart" << endl;
-	restart_threshold = static_cast<int>(restart_threshold * restart_multiplier);
-	if (restart_threshold > restart_upper) {
-		restart_threshold = restart_lower;
-		restart_upper = static_cast<int>(restart_upper  * restart_multiplier);
-		if (verbose >= 1) cout << "new restart upper bound = " << restart_upper << endl;
+	if (RestartPolicy == RESTART_POLICY::LOCAL) {
+		restart_threshold = static_cast<int>(restart_threshold * restart_multiplier);
+		if (restart_threshold > restart_upper) {
+			restart_threshold = restart_lower;
+			restart_upper = static_cast<int>(restart_upper  * restart_multiplier);
+			if (verbose >= 1) cout << "new restart upper bound = " << restart_upper << endl;
+		}
+		if (verbose >=1) cout << "restart: new threshold = " << restart_threshold << endl;
 	}
-	if (verbose >=1) cout << "restart: new threshold = " << restart_threshold << endl;
+	if (RestartPolicy == RESTART_POLICY::SWITCHING && num_learned >= mode_switch_at) switch_mode();
+	last_restart = num_learned;
+	++luby_index;
 	++num_restarts;
-	for (unsigned int i = 1; i <= nvars; ++i) 
-		if (dlevel[i] > 0) {
-			state[i] = VarState::V_UNASSIGNED;
-			dlevel[i] = 0;
-		}	
-	trail.clear();
-	qhead = 0;
+	if (reused) {
+		num_reused_levels += reused;
+		cancel_until(reused);
+		for (int i = 1; i <= reused; ++i) conflicts_at_dl[i] = num_learned; // as if the levels were rebuilt now
+		return;
+	}
+	unextend_model();
+	if (dl > 0) cancel_until(0); // level 0 stays, so that the inprocessing passes see all of it
+	inprocess_pending = true;
 	separators.clear(); 
 	conflicts_at_dl.clear(); 
-	if (VarDecHeuristic == VAR_DEC_HEURISTIC::MINISAT) {
-		m_curr_activity = 0; // The activity does not really become 0. When it is reset in decide() it becomes the largets activity. 
-		m_should_reset_iterators = true;
-	}
 	reset();
 }
 
@@ -655,17 +1974,31 @@ void Solver::solve() {
 }
 
 SolverState Solver::_solve() {
+	set_failed({});
+	if (inconsistent) return SolverState::UNSAT;
 	SolverState res;
 	while (true) {
 		if (timeout > 0 && cpuTime() - begin_time > timeout) return SolverState::TIMEOUT;
 		while (true) {
 			res = BCP();
 			if (res == SolverState::UNSAT) return res;
-			if (res == SolverState::CONFLICT)
-				backtrack(analyze(cnf[conflicting_clause_idx]));
+			if (res == SolverState::CONFLICT) {
+				if (chrono && conflict_level() == 0) {
+					inconsistent = true;
+					return SolverState::UNSAT;
+				}
+				if (ValDecHeuristic == VAL_DEC_HEURISTIC::TARGET) update_target_phases();
+				backtrack(analyze(conflicting_clause));
+				if (num_learned >= next_reduce) reduce_db();
+				if (ValDecHeuristic == VAL_DEC_HEURISTIC::TARGET && num_learned >= next_rephase) rephase();
+				if (conflict_limit >= 0 && num_learned >= conflict_limit) return SolverState::TIMEOUT;
+			}
 			else break;
 		}
+		if (simplify_due()) simplify();
+		if (inprocess_due() && inprocess() == SolverState::UNSAT) return SolverState::UNSAT;
 		res = decide();
+		if (res == SolverState::UNSAT) return res; // under the assumptions
 #ifdef EDUSAT_DEBUG
         if (res == SolverState::SAT) S.validate_assignment();
 #endif
@@ -676,4 +2009,43 @@ SolverState Solver::_solve() {
 	}
 }
 
+/*
+	Called after an UNSAT solve under assumptions. Tries to drop the failed assumptions one by one: the solve without one of them 
+	gets Core_min_conflicts conflicts, and if it is UNSAT, the failed assumptions become those of that solve, which are at most as many.
+	If it is SAT or runs out of conflicts, the assumption is kept. The solver is left with the assumptions it was called with.
+	Clauses learned on the way are kept, as they do not depend on the assumptions.
+*/
+SolverState Solver::minimize_core() {
+	vector<Lit> core = failed, saved = assumptions;
+	size_t before = core.size();
+	for (size_t i = 0; i < core.size(); ) {
+		assumptions = core;
+		assumptions.erase(assumptions.begin() + i);
+		if (dl > 0) cancel_until(0);
+		conflict_limit = num_learned + Core_min_conflicts;
+		SolverState res = _solve();
+		conflict_limit = -1;
+		if (res == SolverState::SAT) unextend_model();
+		if (res != SolverState::UNSAT) { ++i; continue; } // core[i] is needed, as far as we know
+		if (inconsistent) {
+			core.clear();
+			break;
+		}
+		// the new core is a subset of the old one without core[i]. Its assumptions before i were already found needed.
+		size_t k = 0, next_i = 0;
+		for (size_t j = 0; j < core.size(); ++j) 
+			if (failed_lit[core[j]]) {
+				if (j < i) ++next_i;
+				core[k++] = core[j];
+			}
+		core.resize(k);
+		i = next_i;
+	}
+	if (dl > 0) cancel_until(0);
+	assumptions = saved;
+	set_failed(core);
+	if (verbose >= 1) cout << "minimize_core: " << before << " -> " << core.size() << " failed assumptions" << endl;
+	return SolverState::UNSAT;
+}
+
 #pragma endregion solving
@@ -1,13 +1,17 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <iterator>
 #include <vector>
-#include <unordered_set>
 #include <map>
 #include <string>
+#include <sstream>
 #include <fstream>
 #include <cassert>
+#include <cstdint>
 #include <ctime>
+#include <new>
 #include "options.h"
 using namespace std;
 
@@ -16,6 +20,10 @@ typedef int Lit;
 typedef vector<Lit> clause_t;
 typedef clause_t::iterator clause_it;
 typedef vector<Lit> trail_t;
+typedef uint32_t CRef; // offset of a clause in the clause arena
+
+#define CRef_Undef UINT32_MAX
+#define CRef_Bin 0x80000000u // tag of a CRef that stands for a binary clause. The remaining bits hold the clause's other literal.
 
 #define Assert(exp) AssertCheck(exp, __func__, __LINE__)
 
@@ -24,10 +32,48 @@ typedef vector<Lit> trail_t;
 #define Restart_multiplier 1.1f
 #define Restart_lower 100
 #define Restart_upper 1000
+#define Glucose_K 0.8 // restart once the fast lbd average times this is above the slow one
+#define Glucose_R 1.4 // block a restart when the trail is larger than this times its average
+#define Glucose_min_conflicts 50 // # conflicts between two glucose restarts
+#define Glucose_block_after 10000 // # conflicts before restarts may be blocked
+#define Rephase_first 1000 // # conflicts before the first rephasing (VAL_DEC_HEURISTIC::TARGET)
+#define Rephase_increment 1000 // the gap between rephasings grows by this many conflicts every time
+#define Chrono_min_jump 100 // with chronological backtracking, a backjump over more levels than this undoes only the last level
+#define Elim_max_resolutions 400 // a variable is eliminated only if the product of its # positive and # negative occurrences is at most this
+#define Elim_max_resolvent 20 // ... and none of its resolvents is longer than this
+#define Elim_effort 0.5 // an eliminate() pass may try this many resolutions per propagation of the search since the previous one
+#define Elim_min_budget 100000 // ... but at least this many
+#define Elim_interval 5000 // # conflicts before an eliminate() pass that ran out of budget is continued (it also runs when irredundant clauses are added)
+#define Subsume_interval 10000 // # conflicts between two subsume() passes (it also runs when irredundant clauses are added)
+#define Subsume_max_size 100 // longer clauses are left out of subsume()
+#define Subsume_effort 0.5 // a subsume() pass may check this many candidate clauses per propagation of the search since the previous one
+#define Subsume_min_budget 100000 // ... but at least this many
+#define Probe_interval 5000 // # conflicts between two probe() passes
+#define Probe_effort 0.1 // a probe() pass may use this fraction of the propagations of the search since the previous one
+#define Probe_min_budget 20000 // ... but at least this many propagations
+#define Vivify_interval 3000 // # conflicts between two vivify() passes
+#define Vivify_effort 0.2 // a vivify() pass may scan this many watchers per propagation of the search since the previous one
+#define Vivify_min_budget 10000 // ... but at least this many
+#define Subst_interval 2000 // # conflicts between two substitute() passes (it runs only if the binary clauses changed)
+#define Core_min_conflicts 1000 // # conflicts of each solve of minimize_core() that tries to drop an assumption
+#define Luby_unit 100 // # conflicts of a unit of the Luby sequence
+#define Mode_first 1000 // # conflicts of the first focused mode, with RESTART_POLICY::SWITCHING
+#define Mode_growth 2 // the budget of the modes is multiplied by this on every switch
+#define Ema_lbd_fast 0.03125 // smoothing factors of the exponential moving averages
+#define Ema_lbd_slow 0.0001
+#define Ema_trail 0.0002
 #define Max_bring_forward 10
 #define var_decay 0.99
+#define Lrb_step_start 0.4
+#define Lrb_step_min 0.06
+#define Lrb_step_decrement 1e-6
 #define Rescale_threshold 1e100
 #define Assignment_file "assignment.txt"
+#define Tier1_lbd 2 // learned clauses with an lbd up to this are kept forever ("core")
+#define Tier2_lbd 6 // learned clauses with an lbd up to this survive reductions while they keep being used ("tier 2"). The rest are "local".
+#define Reduce_first 2000 // # conflicts before the first reduction of the learned clauses
+#define Reduce_increment 300 // the gap between reductions grows by this many conflicts every time
+#define Garbage_fraction 0.2 // the clause arena is compacted once this fraction of it belongs to deleted clauses
 
 void Abort(string s, int i);
 
@@ -50,6 +96,21 @@ enum class ClauseState {
 	C_UNDEF
 };
 
+// What rephasing resets the saved phases to.
+enum class Phase : char {
+	ORIGINAL,	// false, the initial phase
+	INVERTED,	// true
+	BEST,		// the assignment of the longest conflict-free trail so far
+	RANDOM
+};
+
+// Cache of Solver::lit_redundant(), per variable.
+enum class MinState : char {
+	UNKNOWN,
+	REMOVABLE,
+	POISONED
+};
+
 enum class SolverState{
 	UNSAT,
 	SAT,
@@ -105,37 +166,63 @@ inline int l2rl(int l) {
 }
 
 
+// Binary clauses are not stored in the arena, so when one is the reason (or the conflict)
+// it is referred to by a tagged CRef holding its literal other than the implied one.
+inline bool is_bin_ref(CRef r) { return r != CRef_Undef && (r & CRef_Bin); }
+inline CRef bin_ref(Lit other) { return CRef_Bin | other; }
+inline Lit bin_ref_lit(CRef r) { return r & ~CRef_Bin; }
+
 /********** classes ******/ 
 
+/* A clause as it is laid out in the clause arena: a fixed header followed by the
+   literals inline. Clauses are never copied around; they are referred to by a CRef,
+   the 32-bit offset of their header in the arena. */
 class Clause {
-	clause_t c;
-	int lw,rw; //watches;	
+	unsigned int sz;
+	int lw,rw; //watches. After the clause is relocated, lw holds its new CRef.
+	unsigned int learnt : 1;
+	unsigned int deleted : 1;
+	unsigned int relocated : 1;
+	unsigned int used : 2; // learned clauses: # of reductions it survives without being used again.
+	unsigned int vivified : 1; // vivify() already tried it
+	unsigned int lbd : 26; // learned clauses: # of distinct decision levels in the clause (literal block distance).
+	Lit c[0]; // the literals, allocated right after the header.
+	friend class ClauseArena;
+	Clause(const clause_t& lits, bool is_learnt) : sz(lits.size()), lw(0), rw(1), learnt(is_learnt), deleted(0), relocated(0), used(0), vivified(0), lbd(0) {
+		copy(lits.begin(), lits.end(), c);
+	}
 public:	
-	Clause(){};
-	void insert(int i) {c.push_back(i);}
 	void lw_set(int i) {lw = i; /*assert(lw != rw);*/}
 	void rw_set(int i) {rw = i; /*assert(lw != rw);*/}	
-	clause_t& cl() {return c;}
 	int get_lw() {return lw;}
 	int get_rw() {return rw;}
 	int get_lw_lit() {return c[lw];}
 	int get_rw_lit() {return c[rw];}
 	int  lit(int i) {return c[i];} 		
-	inline ClauseState next_not_false(bool is_left_watch, Lit other_watch, bool binary, int& loc); 
-	size_t size() {return c.size();}
-	void reset() { c.clear(); }	
-	void print() {for (clause_it it = c.begin(); it != c.end(); ++it) {cout << *it << " ";}; }
+	bool is_learnt() {return learnt;}
+	bool is_deleted() {return deleted;}
+	int  get_lbd() {return lbd;}
+	void set_lbd(int i) {lbd = i;}
+	int  get_used() {return used;}
+	void set_used(int i) {used = i;}
+	bool is_vivified() {return vivified;}
+	void set_vivified(bool b) {vivified = b;}
+	Lit* begin() {return c;}
+	Lit* end() {return c + sz;}
+	inline ClauseState next_not_false(bool is_left_watch, Lit other_watch, int& loc); 
+	size_t size() {return sz;}
+	void print() {for (Lit* it = begin(); it != end(); ++it) {cout << *it << " ";}; }
 	void print_real_lits() {
 		Lit l; 
 		cout << "("; 
-		for (clause_it it = c.begin(); it != c.end(); ++it) { 
+		for (Lit* it = begin(); it != end(); ++it) { 
 			l = l2rl(*it); 
 			cout << l << " ";} cout << ")"; 
 	}
 	void print_with_watches() {		
-		for (clause_it it = c.begin(); it != c.end(); ++it) {
+		for (Lit* it = begin(); it != end(); ++it) {
 			cout << l2rl(*it);
-			int j = distance(c.begin(), it); //also could write "int j = i - c.begin();"  : the '-' operator is overloaded to allow such things. but distance is more standard, as it works on all standard containers.
+			int j = distance(begin(), it); //also could write "int j = i - c.begin();"  : the '-' operator is overloaded to allow such things. but distance is more standard, as it works on all standard containers.
 			if (j == lw) cout << "L";
 			if (j == rw) cout << "R";
 			cout << " ";
@@ -143,50 +230,210 @@ public:
 	}
 };
 
+// One contiguous block holding all the clauses. A clause is addressed by the offset of its header.
+class ClauseArena {
+	vector<uint32_t> mem;
+	size_t wasted_words = 0; // taken by deleted clauses
+public:
+	CRef alloc(const clause_t& lits, bool learnt) {
+		Assert(mem.size() + clause_words(lits.size()) < CRef_Bin);
+		CRef r = static_cast<CRef>(mem.size());
+		mem.resize(mem.size() + clause_words(lits.size()));
+		new (&mem[r]) Clause(lits, learnt);
+		return r;
+	}
+	// Drops the literals from position new_size on. Their words are wasted until the next garbage collection.
+	void shrink(CRef r, size_t new_size) {
+		Clause& c = (*this)[r];
+		wasted_words += clause_words(c.size()) - clause_words(new_size);
+		c.sz = new_size;
+	}
+	void free(CRef r) { 
+		Clause& c = (*this)[r];
+		c.deleted = 1;
+		wasted_words += clause_words(c.size());
+	}
+	// Copies the clause to the arena 'to' (once), and returns its CRef there.
+	CRef relocate(CRef r, ClauseArena& to) {
+		Clause& c = (*this)[r];
+		if (c.relocated) return c.lw;
+		CRef nr = static_cast<CRef>(to.mem.size());
+		to.mem.insert(to.mem.end(), &mem[r], &mem[r] + clause_words(c.size()));
+		c.relocated = 1;
+		c.lw = nr;
+		return nr;
+	}
+	Clause& operator[](CRef r) { return *reinterpret_cast<Clause*>(&mem[r]); }
+	size_t size() { return mem.size(); }
+	size_t wasted() { return wasted_words; }
+	void reserve(size_t words) { mem.reserve(words); }
+	static size_t clause_words(size_t lits) { return (sizeof(Clause) + lits * sizeof(Lit)) / sizeof(uint32_t); }
+};
+
+// An entry in a watch list. The blocker is some other literal of the clause: 
+// if it is satisfied, BCP can skip the clause without reading it from the arena.
+struct Watcher {
+	CRef cref;
+	Lit blocker;
+};
+
+// An exponential moving average. The bias towards the initial 0 is corrected, so early values are meaningful too.
+struct Ema {
+	double alpha, biased = 0, beta = 1, value = 0;
+	explicit Ema(double _alpha) : alpha(_alpha) {}
+	void update(double x) {
+		biased += alpha * (x - biased);
+		beta *= 1 - alpha;
+		value = beta < 1e-12 ? biased : biased / (1 - beta);
+	}
+};
+
+inline void print_real_lits(const clause_t& c) {
+	cout << "("; 
+	for (Lit l : c) cout << l2rl(l) << " ";
+	cout << ")"; 
+}
+
 struct Solver {
-	vector<Clause> cnf; // clause DB. 
+	ClauseArena ca; // clause DB. 
+	vector<CRef> cnf; // the original clauses in the arena, in order of addition.
+	vector<CRef> learnts; // the learned clauses in the arena.
+	vector<unsigned int> lbd_stamp; // decision level => the last compute_lbd() call that saw it.
+	unsigned int lbd_time = 0;
+	int next_reduce = Reduce_first, // num_learned at which reduce_db() runs next
+		reduce_interval = Reduce_first;
 	vector<int> unaries; 
 	trail_t trail;  // assignment stack	
 	vector<int> separators; // indices into trail showing increase in dl 	
 	vector<int> LitScore; // literal => frequency of this literal (# appearances in all clauses). 
-	vector<vector<int> > watches;  // Lit => vector of clause indices into CNF
+	vector<vector<Watcher> > watches;  // Lit => vector of clauses watched by it
+	vector<vector<Lit> > bin_watches;  // Lit => the literals implied when it becomes false. Binary clauses are stored only here.
 	vector<VarState> state;  // current assignment
+	vector<int8_t> lit_val;  // Lit => its LitState under the current assignment. Kept in sync with state, so that lit_state() is a single load.
 	vector<VarState> prev_state; // for phase-saving: same as state, only that it is not reset to 0 upon backtracking. 
-	vector<int> antecedent; // var => clause index in the cnf vector. For variables that their value was assigned in BCP, this is the clause that gave this variable its value. 
+	// Used by VAL_DEC_HEURISTIC::TARGET.
+	vector<VarState> target_phase; // Var => its value in the longest conflict-free trail since the last rephasing. V_UNASSIGNED if none.
+	vector<VarState> best_phase; // Var => same, since the last rephasing to the best phase.
+	unsigned int	target_size = 0, // # literals of the trail that target_phase holds
+					best_size = 0;
+	int				next_rephase = Rephase_first, // num_learned at which rephase() runs next
+					num_rephases = 0;
+	unsigned int	rand_seed = 91648253; // for Phase::RANDOM
+	vector<CRef> antecedent; // var => clause in the arena. For variables that their value was assigned in BCP, this is the clause that gave this variable its value. CRef_Undef for decisions and unaries.
 	vector<bool> marked;	// var => seen during analyze()
+	clause_t new_clause;	// the clause being learned by analyze(). Kept as a member so that its memory is reused.
+	vector<bool> lit_seen;	// Lit => scratch mark of the simplification passes
+	
+	// Bounded variable elimination
+	vector<bool> eliminated; // Var => eliminated by eliminate() or substitute(). Its clauses are on elim_stack.
+	vector<bool> frozen;	// Var => must not be eliminated (it is assumed)
+	vector<Lit> elim_stack; // the clauses removed by eliminate(), as [size, the eliminated literal, the other literals...]
+	bool elim_pending = true; // irredundant clauses were added since the last eliminate()
+	bool elim_incomplete = false; // the last eliminate() ran out of budget. It is continued after Elim_interval conflicts
+	vector<bool> elim_touched; // Var => its irredundant clauses changed since eliminate() last tried it
+	bool subsume_pending = true; // irredundant clauses were added since the last subsume()
+	Lit probe_next = 0;		// the literal probe() stopped at
+	long long num_propagations = 0, // # trail literals that BCP() propagated
+		inprocess_propagations = 0; // ... of them, in inprocess()
+
+	// An inprocessing pass, as scheduled by inprocess(). 
+	struct Pass {
+		const char* name;
+		bool (Solver::*due)();
+		SolverState (Solver::*run)();
+		int interval;		// # conflicts between two runs
+		double effort;		// its budget is this much per search propagation since it last ran,
+		long long min_budget;	// but at least this. The pass decides what the budget counts (propagations, resolutions, ...).
+		int next = 0;		// num_learned from which it may run again
+		long long last = 0;	// search_propagations() when it last ran
+		long long budget = 0;	// of the current run
+		int runs = 0;
+		double time = 0;	// secs spent in it
+	};
+	Pass subsume_pass = { "subsume", &Solver::subsume_due, &Solver::subsume, Subsume_interval, Subsume_effort, Subsume_min_budget, Subsume_interval },
+		substitute_pass = { "substitute", &Solver::substitute_due, &Solver::substitute, Subst_interval, 0, 0 }, // linear, so not budgeted
+		elim_pass = { "eliminate", &Solver::elim_due, &Solver::eliminate, Elim_interval, Elim_effort, Elim_min_budget },
+		probe_pass = { "probe", &Solver::probe_due, &Solver::probe, Probe_interval, Probe_effort, Probe_min_budget },
+		vivify_pass = { "vivify", &Solver::vivify_due, &Solver::vivify, Vivify_interval, Vivify_effort, Vivify_min_budget, Vivify_interval };
+	bool inprocess_pending = true; // a (full) restart happened since the last inprocess()
+	array<Pass*, 5> passes() { return { { &subsume_pass, &substitute_pass, &elim_pass, &probe_pass, &vivify_pass } }; }
+	vector<MinState> min_state; // var => whether lit_redundant() found it implied by the learned clause. Reset after each analyze().
+	vector<Var> min_to_clear; // the variables whose min_state is set
+	vector<pair<Lit, int> > min_stack; // lit_redundant()'s DFS stack: a literal and the next position in its antecedent.
 	vector<int> dlevel; // var => decision level in which this variable was assigned its value. 
 	vector<int> conflicts_at_dl; // decision level => # of conflicts under it. Used for local restarts. 
 
-	// Used by VAR_DH_MINISAT:	
-    vector<bool> m_HasVarBeenPutInScore2Vars;
-	map<double, unordered_set<Var>, greater<double>> m_Score2Vars; // 'greater' forces an order from large to small of the keys
-	map<double, unordered_set<Var>, greater<double>>::iterator m_Score2Vars_it;
-	unordered_set<Var>::iterator m_VarsSameScore_it;
+	// Used by VAR_DH_MINISAT and VAR_DH_LRB:	
+	vector<Var>		m_heap; // binary max-heap of variables, ordered by m_activity. Every unassigned variable is in it; assigned ones are removed lazily by decide().
+	vector<int>		m_heap_idx; // Var => its position in m_heap, -1 if not in it.
 	vector<double>	m_activity; // Var => activity
 	double			m_var_inc = 0;	// current increment of var score (it increases over time)
-	double			m_curr_activity = 0;
-	bool			m_should_reset_iterators = 0;
+
+	// Used by VAR_DH_VMTF:
+	vector<Var>		vmtf_prev, vmtf_next; // Var => its neighbours in the decision queue (0 at the ends). The queue is ordered by vmtf_stamp.
+	vector<long long> vmtf_stamp; // Var => the time it was last moved to the front of the queue.
+	Var				vmtf_first = 0, vmtf_last = 0; // vmtf_last is the front: the most recently bumped variable.
+	Var				vmtf_search = 0; // where decide() starts looking. All the variables after it in the queue are assigned.
+	long long		vmtf_time = 0;
+	vector<Var>		vmtf_analyzed; // the variables seen in the current analyze(), to be bumped.
+
+	// Used by VAR_DH_LRB. The scores themselves are kept in m_activity, so that m_heap orders them.
+	vector<int>		lrb_assigned_at; // Var => num_learned when it was last assigned
+	vector<int>		lrb_participated; // Var => # learned clauses it took part in deriving since it was assigned
+	vector<int>		lrb_reasoned; // Var => # times it was in the reason of a learned clause literal since it was assigned
+	double			lrb_step = Lrb_step_start; // the learning rate of the moving average. Decays over time.
 
 	unsigned int 
 		nvars = 0,			// # vars
 		nclauses = 0, 		// # clauses
+		nbins = 0,			// # binary clauses (in bin_watches)
 		nlits = 0,			// # literals = 2*nvars				
-		qhead = 0;			// index into trail. Used in BCP() to follow the propagation process.
+		qhead = 0,			// index into trail. Used in BCP() to follow the propagation process.
+		simplified_units = 0,	// trail size (at level 0) after the last simplify()
+		substituted_bins = 0;	// nbins after the last substitute()
 	int					
 		num_learned = 0, 	
 		num_decisions = 0,
 		num_assignments = 0,
 		num_restarts = 0,
+		num_blocked_restarts = 0,
+		num_reductions = 0,
+		num_deleted = 0,	// # learned clauses deleted by reduce_db()
+		num_minimized = 0,	// # literals removed from learned clauses by minimization
+		num_simplifications = 0,
+		num_satisfied = 0,	// # clauses deleted by simplify() because they are satisfied at level 0
+		num_false_lits = 0,	// # false literals removed by simplify()
+		num_eliminated = 0,	// # variables eliminated
+		num_substituted = 0,	// # variables replaced by an equivalent literal
+		num_failed = 0,		// # failed literals found by probe()
+		num_hbrs = 0,		// # hyper-binary resolvents added by probe()
+		num_vivified = 0,	// # clauses strengthened by vivify()
+		num_vivified_lits = 0,	// # literals removed by vivify()
+		num_subsumed = 0,	// # clauses deleted by subsume()
+		num_strengthened = 0,	// # literals removed by self-subsuming resolution in subsume()
+		num_chrono_backtracks = 0,	// # backtracks that undid only the last level (chronological backtracking)
 		dl = 0,				// decision level
 		max_dl = 0,			// max dl seen so far since the last restart
-		conflicting_clause_idx = 0, // holds the index of the current conflicting clause in cnf[]. -1 if none.				
 		restart_threshold = 0,
 		restart_lower = 0,
-		restart_upper = 0;
+		restart_upper = 0,
+		last_restart = 0,	// num_learned at the last restart
+		luby_index = 0,		// position in the Luby sequence
+		mode_budget = Mode_first,	// # conflicts of the current mode (RESTART_POLICY::SWITCHING)
+		mode_switch_at = Mode_first,	// num_learned at which the mode switches
+		num_mode_switches = 0,
+		num_reused_levels = 0;	// # decision levels kept by restarts
+	bool stable = false;	// with RESTART_POLICY::SWITCHING: in stable (Luby) mode rather than focused (glucose) mode
+	bool inconsistent = false; // the formula is unsatisfiable regardless of assumptions (an empty clause was derived or added)
 
 	Lit 		asserted_lit = 0;
+	CRef		asserting_clause = CRef_Undef; // the clause learned by the last analyze(). CRef_Undef if it was unary.
+	CRef		conflicting_clause = CRef_Undef; // the current conflicting clause. CRef_Undef if none.
+	Lit			conflicting_lit = 0; // when conflicting_clause is a binary, its literal that is not in the CRef.
+	CRef		ignored_clause = CRef_Undef; // BCP() skips it; the clause that vivify() tries.
 
 	float restart_multiplier = 0;
+	Ema lbd_fast{ Ema_lbd_fast }, lbd_slow{ Ema_lbd_slow }, trail_avg{ Ema_trail }; // for RESTART_POLICY::GLUCOSE
 
     int (*terminate_callback)(void*) = nullptr;
     void* terminate_callback_state = nullptr;
@@ -194,15 +441,19 @@ struct Solver {
     void (*learn_callback)(void*, int*) = nullptr;
     void* learn_callback_state = nullptr;
     int learn_callback_max_length = 0;
+    vector<int> learn_callback_buffer; // the learned clause passed to learn_callback, in cnf-like form.
 
-    std::unordered_set<int> indices_of_temporary_assertions;
+    vector<Lit> assumptions; // of the next solve. Assumption i is decided at level i + 1, before any other decision.
+    vector<Lit> failed; // the assumptions that together made the last solve UNSAT (analyze_final()). Empty if the formula is UNSAT by itself.
+    vector<bool> failed_lit; // Lit => in failed
+    int conflict_limit = -1; // _solve() stops with TIMEOUT once num_learned reaches this. -1: no limit.
 	
 	// access	
 	int get_learned() { return num_learned; }
 	void set_nvars(int x) { nvars = x; }
 	int get_nvars() { return nvars; }
 	void set_nclauses(int x) { nclauses = x; }
-	size_t cnf_size() { return cnf.size(); }
+	size_t cnf_size() { return cnf.size() + learnts.size() + nbins; }
 	VarState get_state(int x) { return state[x]; }
 
 	// misc.
@@ -211,25 +462,83 @@ struct Solver {
 	void make_space_for_vars();
 	void reset(); // initialization that is invoked initially + every restart
 	void initialize();
-	void reset_iterators(double activity_key = 0.0);	
 
 	// solving	
 	SolverState decide();
 	void test();
 	SolverState BCP();
-	int  analyze(const Clause&);
+	int  analyze(CRef conflicting);
+	void analyze_final(Lit p);
+	void set_failed(const vector<Lit>& lits);
+	SolverState minimize_core();
+	unsigned int abstract_level(Var v) { return 1u << (dlevel[v] & 31); }
+	bool lit_redundant(Lit p, unsigned int abstract_levels);
 	inline int  getVal(Var v);
-	void add_clause(Clause& c, int l, int r);
+	CRef add_clause(const clause_t& c, int l, int r, bool learnt = false);
+	void add_bin_clause(Lit l, Lit r);
 	void add_unary_clause(Lit l);
-	void assert_lit(Lit l);	
-	void temporary_assert(Lit l);	
-    void unassert_temporaries();
-	void m_rescaleScores(double& new_score);
+	void add_input_clause(clause_t& lits);
+	void assert_lit(Lit l, CRef reason = CRef_Undef);	
+	inline void unassign(Var v);
+	void m_rescaleScores();
 	inline void backtrack(int k);
-	void restart();
+	void cancel_until(int k);
+	int reason_level(Lit l, CRef reason);
+	int conflict_level();
+	void restart(int reused = 0);
+	void update_target_phases();
+	void rephase();
+	int reusable_levels(int k);
+	bool restart_due(int k);
+	void switch_mode();
+	void update_restart_stats(int lbd);
+	template<class It> int compute_lbd(It begin, It end);
+	void bump_clause(CRef cr);
+	bool locked(CRef cr);
+	void reduce_db();
+	void garbage_collect();
+	void simplify();
+	SolverState inprocess();
+	bool inprocess_due() { return inprocess_pending && dl == 0; }
+	bool passes_due() { for (Pass* p : passes()) if ((this->*p->due)()) return true; return false; }
+	long long search_propagations() { return num_propagations - inprocess_propagations; }
+	string inprocess_stats();
+	SolverState subsume();
+	bool subsume_due() { return subsume_pending || num_learned >= subsume_pass.next; }
+	SolverState probe();
+	bool probe_due() { return num_learned >= probe_pass.next; }
+	void new_decision_level();
+	SolverState vivify();
+	bool vivify_due() { return num_learned >= vivify_pass.next; }
+	void detach(CRef cr);
+	SolverState substitute();
+	bool substitute_due() { return num_learned >= substitute_pass.next && nbins != substituted_bins; }
+	SolverState eliminate();
+	bool elim_due() { return elim && (elim_pending || (elim_incomplete && num_learned >= elim_pass.next)); }
+	void touch(Lit l) { elim_touched[l2v(l)] = true; }
+	bool resolve(const clause_t& p, const clause_t& n, clause_t& out);
+	void extend_model();
+	void unextend_model();
+	void restore(Var v);
+	void freeze(Var v) { frozen[v] = true; restore(v); }
+	void unfreeze(Var v) { frozen[v] = false; elim_touched[v] = true; }
+	bool decidable(Var v) { return state[v] == VarState::V_UNASSIGNED && !eliminated[v]; }
+	bool simplify_due() { return dl == 0 && trail.size() > simplified_units; }
 	
 	// scores	
+	bool heap_contains(Var v) { return m_heap_idx[v] >= 0; }
+	void heap_insert(Var v);
+	Var  heap_remove_max();
+	void heap_up(int i);
+	void heap_down(int i);
+	void heap_update(Var v) { heap_up(m_heap_idx[v]); heap_down(m_heap_idx[v]); }
+	bool uses_heap() { return VarDecHeuristic == VAR_DEC_HEURISTIC::MINISAT || VarDecHeuristic == VAR_DEC_HEURISTIC::LRB; }
 	void bumpVarScore(int idx);
+	void vmtf_enqueue(Var v);
+	void vmtf_dequeue(Var v);
+	void vmtf_bump_analyzed();
+	void lrb_reward(Var v);
+	void lrb_bump_reasons(const clause_t& learned);
 	void bumpLitScore(int lit_idx);
 
 public:
@@ -241,8 +550,7 @@ public:
 	
 	// service functions
 	inline LitState lit_state(Lit l) {
-		VarState var_state = state[l2v(l)];
-		return var_state == VarState::V_UNASSIGNED ? LitState::L_UNASSIGNED : (Neg(l) && var_state == VarState::V_FALSE || !Neg(l) && var_state == VarState::V_TRUE) ? LitState::L_SAT : LitState::L_UNSAT;
+		return static_cast<LitState>(lit_val[l]);
 	}
 	inline LitState lit_state(Lit l, VarState var_state) {
 		return var_state == VarState::V_UNASSIGNED ? LitState::L_UNASSIGNED : (Neg(l) && var_state == VarState::V_FALSE || !Neg(l) && var_state == VarState::V_TRUE) ? LitState::L_SAT : LitState::L_UNSAT;
@@ -257,15 +565,15 @@ public:
 	
 // debugging
 	void print_cnf(){
-		for(vector<Clause>::iterator i = cnf.begin(); i != cnf.end(); ++i) {
-			i -> print_with_watches(); 
+		for(vector<CRef>::iterator i = cnf.begin(); i != cnf.end(); ++i) {
+			ca[*i].print_with_watches(); 
 			cout << endl;
 		}
 	} 
 
 	void print_real_cnf() {
-		for(vector<Clause>::iterator i = cnf.begin(); i != cnf.end(); ++i) {
-			i -> print_real_lits(); 
+		for(vector<CRef>::iterator i = cnf.begin(); i != cnf.end(); ++i) {
+			ca[*i].print_real_lits(); 
 			cout << endl;
 		}
 	} 
@@ -289,10 +597,10 @@ public:
 	}	
 	
 	void print_watches() {
-		for (vector<vector<int> >::iterator it = watches.begin() + 1; it != watches.end(); ++it) {
+		for (vector<vector<Watcher> >::iterator it = watches.begin() + 1; it != watches.end(); ++it) {
 			cout << distance(watches.begin(), it) << ": ";
-			for (vector<int>::iterator it_c = (*it).begin(); it_c != (*it).end(); ++it_c) {
-				cnf[*it_c].print();
+			for (vector<Watcher>::iterator it_c = (*it).begin(); it_c != (*it).end(); ++it_c) {
+				ca[it_c->cref].print();
 				cout << "; ";
 			}
 			cout << endl;
@@ -301,9 +609,20 @@ public:
 
 
 	void print_stats() {cout << endl << "Statistics: " << endl << "===================" << endl << 
-		"### Restarts:\t\t" << num_restarts << endl <<
+		"### Restarts:\t\t" << num_restarts << " (" << num_blocked_restarts << " blocked, " << num_mode_switches << " mode switches, " << num_reused_levels << " levels reused)" << endl <<
 		"### Learned-clauses:\t" << num_learned << endl <<
+		"### Minimized-literals:\t" << num_minimized << endl <<
+		"### Rephases:\t\t" << num_rephases << endl <<
+		"### Simplified:\t\t" << num_satisfied << " satisfied clauses, " << num_false_lits << " false literals (in " << num_simplifications << " simplifications)" << endl <<
+		"### Vivified:\t\t" << num_vivified << " clauses, " << num_vivified_lits << " literals removed" << endl <<
+		"### Probing:\t\t" << num_failed << " failed literals, " << num_hbrs << " hyper-binary resolvents" << endl <<
+		"### Subsumed-clauses:\t" << num_subsumed << " (and " << num_strengthened << " literals strengthened away)" << endl <<
+		"### Eliminated-vars:\t" << num_eliminated << endl <<
+		"### Substituted-vars:\t" << num_substituted << endl <<
+		"### Inprocessing:\t" << inprocess_stats() << endl <<
+		"### Deleted-clauses:\t" << num_deleted << " (in " << num_reductions << " reductions)" << endl <<
 		"### Decisions:\t\t" << num_decisions << endl <<
+		"### Chrono-backtracks:\t" << num_chrono_backtracks << endl <<
 		"### Implications:\t" << num_assignments - num_decisions << endl <<
 		"### Time:\t\t" << cpuTime() - begin_time << endl;
 	}
@@ -55,21 +55,35 @@ void help() {
 }
 
 int verbose = 0;
+int chrono = 0; // chronological backtracking
+int elim = 1; // bounded variable elimination
+int core_min = 0; // minimization of the failed assumptions (incremental mode)
 double begin_time;
 double timeout = 0.0;
 VAR_DEC_HEURISTIC VarDecHeuristic = VAR_DEC_HEURISTIC::MINISAT;
 VAL_DEC_HEURISTIC ValDecHeuristic = VAL_DEC_HEURISTIC::PHASESAVING;
+RESTART_POLICY RestartPolicy = RESTART_POLICY::LOCAL;
 MODE mode = MODE::INCREMENTAL;
 
 auto o1 = intoption(&verbose, 0, 2, "Verbosity level");
 auto o2 = doubleoption(&timeout, 0.0, 36000.0, "Timeout in seconds");
-auto o3 = intoption((int*)&ValDecHeuristic, 0, 1, "{0: phase-saving, 1: literal-score}");
+auto o3 = intoption((int*)&ValDecHeuristic, 0, 2, "{0: phase-saving, 1: literal-score, 2: target-phase}");
 auto o4 = intoption((int*)&mode, 0, 1, "{0: normal, 1: incremental}");
+auto o5 = intoption((int*)&VarDecHeuristic, 0, 2, "{0: minisat, 1: vmtf, 2: lrb}");
+auto o6 = intoption((int*)&RestartPolicy, 0, 3, "{0: local, 1: glucose, 2: luby, 3: switch between glucose and luby}");
+auto o7 = intoption(&chrono, 0, 1, "Chronological backtracking after long jumps {0: off, 1: on}");
+auto o8 = intoption(&elim, 0, 1, "Bounded variable elimination {0: off, 1: on}");
+auto o9 = intoption(&core_min, 0, 1, "Minimize the failed assumptions of an UNSAT solve by solving again without each of them {0: off, 1: on}");
 unordered_map<string, option*> options = {
     {"v",           &o1},
     {"timeout",     &o2},
     {"valdh",       &o3},
-    {"mode",        &o4}
+    {"mode",        &o4},
+    {"vardh",       &o5},
+    {"restart",     &o6},
+    {"chrono",      &o7},
+    {"elim",        &o8},
+    {"coremin",     &o9}
 };
 
 void parse_options(int argc, char** argv) {
@@ -33,7 +33,11 @@ void Abort(string s, int i);
 void parse_options(int argc, char** argv);
 
 enum class VAR_DEC_HEURISTIC {
-    MINISAT
+    MINISAT,
+    /* Variable move-to-front: a queue of the variables, where the ones seen in conflict analysis move to the front */
+    VMTF,
+    /* Learning-rate branching: an exponential moving average of how much a variable took part in conflicts while it was assigned */
+    LRB
     // add other decision heuristics here. Add an option to choose between them.
  } ;
 
@@ -42,7 +46,21 @@ enum class VAL_DEC_HEURISTIC {
     /* Same as last value. Initially false*/
     PHASESAVING, 
     /* Choose literal with highest frequency */
-    LITSCORE 
+    LITSCORE,
+    /* Phase-saving, but prefer the assignment of the longest conflict-free trail (the "target"). The saved phases are periodically reset ("rephasing") */
+    TARGET
+};
+
+// When to restart.
+enum class RESTART_POLICY {
+    /* Restart when the number of conflicts under the backtrack level passes a geometrically growing threshold */
+    LOCAL,
+    /* Glucose: restart when the recent learned clauses have a worse lbd than the long-run average. Blocked while the trail is unusually large */
+    GLUCOSE,
+    /* Restart after a number of conflicts that follows the Luby sequence (reluctant doubling) */
+    LUBY,
+    /* Alternate between a "focused" mode with glucose restarts and a "stable" mode with Luby restarts. Each mode gets a growing conflict budget */
+    SWITCHING
 };
 
 enum class MODE: int {
@@ -52,8 +70,12 @@ enum class MODE: int {
 
 
 extern int verbose;
+extern int chrono;
+extern int elim;
+extern int core_min;
 extern double begin_time;
 extern double timeout;
 extern VAR_DEC_HEURISTIC VarDecHeuristic;
 extern VAL_DEC_HEURISTIC ValDecHeuristic;
+extern RESTART_POLICY RestartPolicy;
 extern MODE mode;
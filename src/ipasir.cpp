@@ -1,7 +1,7 @@
 #include "ipasir.h"
 #include "edusat/edusat.h"
 
-Clause clause;
+clause_t clause;
 bool has_been_reset = true;
 
 
@@ -36,11 +36,19 @@ Lit literal(int lit) {
 }
 
 
+/**
+ * Called before the solver is changed after a solve. The search is kept where
+ * it stopped, so that the next solve continues from there; only the decision
+ * levels of the assumptions of the last solve are dropped with them.
+ */
 void check_reset() {
     if (!has_been_reset) {
-        S.restart();
-        S.unassert_temporaries();
-        for (Lit l : S.unaries) { S.assert_lit(l); }
+        S.unextend_model();
+        if (!S.assumptions.empty()) {
+            if (S.dl > 0) S.cancel_until(0);
+            for (Lit l : S.assumptions) S.unfreeze(l2v(l)); // they may be eliminated again, until assumed again
+            S.assumptions.clear();
+        }
         has_been_reset = true;
     }
 }
@@ -63,7 +71,8 @@ IPASIR_API void * ipasir_init () {
 
 IPASIR_API void ipasir_release (void * state) {
     S = Solver();
-    clause = Clause();
+    clause.clear();
+    has_been_reset = true;
 }
 
 
@@ -71,24 +80,12 @@ IPASIR_API void ipasir_add (void * state, int lit_or_zero) {
     DBG(lit_or_zero);
     check_reset();
     if (lit_or_zero == 0) { // Clause finished!
-        switch (clause.size()) {
-            case 0:
-                throw std::logic_error("Empty clause!");
-            case 1: {
-                int lit = clause.lit(0);
-                S.add_unary_clause(lit);
-                // TODO: Do we need to re-assert this after every
-                // restart/reset?
-                S.assert_lit(lit);
-                break;
-            }
-            default:
-                S.add_clause(clause, 0, 1);
-                break;
-        }
-        clause = Clause();
+        if (clause.empty()) throw std::logic_error("Empty clause!");
+        S.add_input_clause(clause); // also when the solver is in the middle of a search
+        clause.clear();
     } else {
-        clause.insert(literal(lit_or_zero));
+        clause.push_back(literal(lit_or_zero));
+        S.restore(abs(lit_or_zero)); // in case it was eliminated
     }
 }
 
@@ -96,37 +93,23 @@ IPASIR_API void ipasir_add (void * state, int lit_or_zero) {
 IPASIR_API void ipasir_assume (void * state, int lit) {
     DBG(lit);
     check_reset();
-    // Temporary assertions are un-assumed when resetting the model.
-    S.temporary_assert(literal(lit));
-}
-
-
-Var find_bad_var() {
-    vector<VarState> state(S.state.size(), VarState::V_UNASSIGNED);
-    for (Lit l : S.trail) {
-        auto v = Neg(l) ? VarState::V_FALSE : VarState::V_TRUE;
-        auto* cell = &state[l2v(l)];
-        if (*cell != VarState::V_UNASSIGNED && *cell != v) return l2v(l);
-        *cell = v;
-    }
-    return 0;
+    // The assumptions are decided first by the next solve, each at a decision level of its own.
+    Lit l = literal(lit);
+    S.freeze(abs(lit)); // variable elimination must keep the variables that are assumed
+    S.assumptions.push_back(l);
 }
 
 
 IPASIR_API int ipasir_solve (void * state) {
+    check_reset(); // the assumptions of the previous solve are gone
+    // Levels 1 .. assumptions.size() are taken by the assumptions, so the search restarts below them.
+    if (!S.assumptions.empty() && S.dl > 0) S.cancel_until(0);
     has_been_reset = false;
-	if (VarDecHeuristic == VAR_DEC_HEURISTIC::MINISAT) {
-        S.reset_iterators();
-    }
-    // Must first check for bad assumptions!
-    if (Var bad_var = find_bad_var()) {
-        S.assert_lit(v2l(bad_var));
-        return DBG(20);
-    }
     switch (S._solve()) {
         case SolverState::SAT:
             return DBG(10);
         case SolverState::UNSAT:
+            if (core_min && !S.failed.empty()) S.minimize_core();
             return DBG(20);
         case SolverState::TIMEOUT:
             return DBG(0);
@@ -152,8 +135,8 @@ IPASIR_API int ipasir_val (void * state, int lit) {
 
 IPASIR_API int ipasir_failed (void * state, int lit) {
     DBG(lit);
-    literal(lit);
-    return DBG(S.state[abs(lit)] != VarState::V_UNASSIGNED);
+    // The assumptions that analyze_final() found the last solve to be UNSAT under.
+    return DBG(static_cast<int>(S.failed_lit[literal(lit)]));
 }
 
 
@@ -6,13 +6,14 @@
 #include <windows.h>
 #endif
 #include "src/ipasir.h"
+#include "src/edusat/edusat.h" // some tests look at S, the solver behind the IPASIR functions
 
 
 using namespace std;
 using duration = chrono::duration<double, milli>;
 
 
-typedef void* Solver;
+typedef void* IpasirSolver;
 
 
 
@@ -61,8 +62,18 @@ void print_test_summary() {
     }
 
 
-Solver solver_from_string(const std::string& string) {
-    Solver s = ipasir_init();
+// Sets an option of the solver until the end of the scope, even when an
+// ASSERT throws.
+struct OptionGuard {
+    int& option;
+    int before;
+    OptionGuard(int& option, int value) : option(option), before(option) { option = value; }
+    ~OptionGuard() { option = before; }
+};
+
+
+IpasirSolver solver_from_string(const std::string& string) {
+    IpasirSolver s = ipasir_init();
     stringstream ss(string);
     while (true) {
         int x; ss >> x;
@@ -82,7 +93,7 @@ duration measure_time(function<void()> f) {
 
 
 void test_execution_time_decreases() {
-    Solver s = solver_from_string(R"(
+    IpasirSolver s = solver_from_string(R"(
          1  2  3  4  0
         -1  2  3 -4  0
         -1  2  0
@@ -104,7 +115,7 @@ void test_execution_time_decreases() {
 }
 
 
-vector<int> solver_get_assignment(Solver s, int max_var) {
+vector<int> solver_get_assignment(IpasirSolver s, int max_var) {
     vector<int> ret(max_var + 1);
     for (int i = 1; i <= max_var; i++) {
         ret[i] = ipasir_val(s, i);
@@ -134,6 +145,29 @@ string pretty_print_assignment(const vector<int>& a) {
 }
 
 
+vector<vector<int>> clauses_from_string(const string& string) {
+    vector<vector<int>> clauses(1);
+    stringstream ss(string);
+    int x;
+    while (ss >> x) {
+        if (x) clauses.back().push_back(x);
+        else clauses.emplace_back();
+    }
+    clauses.pop_back();
+    return clauses;
+}
+
+
+bool satisfies_all(IpasirSolver s, const vector<vector<int>>& clauses) {
+    for (const auto& clause : clauses) {
+        bool satisfied = false;
+        for (int l : clause) if (ipasir_val(s, abs(l)) == l) satisfied = true;
+        if (!satisfied) return false;
+    }
+    return true;
+}
+
+
 // Obviously, this only works on specific problems.
 void test_flipped_assignment_is_wrong() {
     constexpr int VARS = 3;
@@ -143,7 +177,7 @@ void test_flipped_assignment_is_wrong() {
         3 0
         1 2 3 0
     )";
-    Solver s = solver_from_string(problem);
+    IpasirSolver s = solver_from_string(problem);
     vector<int> values;
 
     cout << "Starting first solve" << endl;
@@ -232,7 +266,7 @@ void test_assume_for_incrementality() {
          -8 -16   0
         -12 -16   0
     )";
-    Solver s = solver_from_string(problem);
+    IpasirSolver s = solver_from_string(problem);
 
     cout << "First solving" << endl;
     int res = ipasir_solve(s);
@@ -264,7 +298,7 @@ void test_assume_for_incrementality() {
 
 
 void test_assume_dissappears() {
-    Solver s = solver_from_string(R"(
+    IpasirSolver s = solver_from_string(R"(
         1 2 3 0
         -1 -2 0
     )");
@@ -294,6 +328,589 @@ void test_assume_dissappears() {
 }
 
 
+void test_add_between_solves() {
+    IpasirSolver s = solver_from_string(R"(
+        1 2 0
+        -2 3 0
+    )");
+
+    cout << "First solve:" << endl;
+    int res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+
+    cout << "Adding clauses that the assignment may violate:" << endl;
+    ipasir_add(s, -1); ipasir_add(s, 0);
+    ipasir_add(s, -3); ipasir_add(s, 4); ipasir_add(s, 0);
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should still succeed");
+    vector<int> assignment = solver_get_assignment(s, 4);
+    ASSERT(assignment[1] == -1, "Assignment does not make since");
+    ASSERT(assignment[2] == 2, "Assignment does not make since");
+    ASSERT(assignment[3] == 3, "Assignment does not make since");
+    ASSERT(assignment[4] == 4, "Assignment does not make since");
+
+    cout << "Adding a contradicting clause:" << endl;
+    ipasir_add(s, -4); ipasir_add(s, -2); ipasir_add(s, 0);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "There should not be a solution");
+    ipasir_add(s, 5); ipasir_add(s, 0);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "Adding clauses cannot make it satisfiable");
+}
+
+
+void test_failed_assumptions() {
+    IpasirSolver s = solver_from_string(R"(
+        -1 -2 0
+        -5 6 0
+        -6 -7 0
+        3 4 8 0
+    )");
+
+    cout << "First solve:" << endl;
+    ipasir_assume(s, 3);
+    ipasir_assume(s, 1);
+    ipasir_assume(s, 4);
+    ipasir_assume(s, 2);
+    int res = ipasir_solve(s);
+    ASSERT(res == 20, "There should not be a solution");
+    ASSERT(ipasir_failed(s, 1) && ipasir_failed(s, 2), "1 and 2 contradict each other");
+    ASSERT(!ipasir_failed(s, 3) && !ipasir_failed(s, 4), "3 and 4 are not needed");
+
+    cout << "Second solve:" << endl;
+    ipasir_assume(s, 7);
+    ipasir_assume(s, 3);
+    ipasir_assume(s, 5);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "There should not be a solution");
+    ASSERT(ipasir_failed(s, 5) && ipasir_failed(s, 7), "5 implies -7 through 6");
+    ASSERT(!ipasir_failed(s, 3) && !ipasir_failed(s, 1), "Only the assumptions of this solve");
+
+    cout << "Third solve:" << endl;
+    ipasir_assume(s, 5);
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "5 alone is fine");
+    ASSERT(ipasir_val(s, 7) == -7, "Assignment does not make since");
+}
+
+
+// The clauses saying that `pigeons` pigeons sit in `holes` holes, no two in
+// the same one. p(i, j) = first + holes * i + j is pigeon i in hole j. With a
+// guard, every clause gets -guard, so they only hold when guard is true.
+string pigeonhole(int pigeons, int holes, int first = 1, int guard = 0) {
+    stringstream php;
+    string g = guard ? to_string(-guard) + " " : "";
+    for (int i = 0; i < pigeons; ++i) {
+        php << g;
+        for (int j = 0; j < holes; ++j) php << first + holes * i + j << " ";
+        php << "0\n";
+    }
+    for (int j = 0; j < holes; ++j)
+        for (int i = 0; i < pigeons; ++i)
+            for (int k = i + 1; k < pigeons; ++k)
+                php << g << -(first + holes * i + j) << " " << -(first + holes * k + j) << " 0\n";
+    return php.str();
+}
+
+
+// 2 alone is contradictory, but only search finds it: it guards 3 pigeons in
+// 2 holes. Assuming 3 and 1 before it implies -2, so the failed assumptions
+// found first are 3, 1 and 2, and minimization leaves 2.
+void test_minimized_core() {
+    OptionGuard no_elim(elim, 0); // it would resolve the pigeons away
+    OptionGuard minimize(core_min, 1);
+    IpasirSolver s = solver_from_string("-3 -1 -2 0\n" + pigeonhole(3, 2, 4, 2));
+
+    cout << "First solve:" << endl;
+    ipasir_assume(s, 3);
+    ipasir_assume(s, 1);
+    ipasir_assume(s, 2);
+    int res = ipasir_solve(s);
+    ASSERT(res == 20, "There should not be a solution");
+    ASSERT(ipasir_failed(s, 2), "2 is needed");
+    ASSERT(!ipasir_failed(s, 1) && !ipasir_failed(s, 3), "1 and 3 are not needed");
+
+    cout << "Second solve:" << endl;
+    ipasir_assume(s, 3);
+    ipasir_assume(s, 1);
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Only the assumptions of this solve");
+    ASSERT(ipasir_val(s, 2) == -2, "Assignment does not make since");
+
+    cout << "Third solve:" << endl;
+    ipasir_assume(s, -3);
+    ipasir_assume(s, 2);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "There should not be a solution");
+    ASSERT(ipasir_failed(s, 2) && !ipasir_failed(s, -3), "Only 2 is needed");
+    ipasir_release(s);
+}
+
+
+// Each assumption takes a decision level, also when it repeats an earlier one
+// or is already true, so there may be more decision levels than variables.
+void test_repeated_assumptions() {
+    // 5 pigeons in 4 holes: p(i, j) = 4 * i + j + 1 is pigeon i in hole j.
+    stringstream php;
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 4; ++j) php << 4 * i + j + 1 << " ";
+        php << "0\n";
+    }
+    for (int j = 0; j < 4; ++j)
+        for (int i = 0; i < 5; ++i)
+            for (int k = i + 1; k < 5; ++k)
+                php << -(4 * i + j + 1) << " " << -(4 * k + j + 1) << " 0\n";
+    IpasirSolver s = solver_from_string(php.str() + "21 0\n");
+
+    cout << "First solve:" << endl;
+    for (int i = 0; i < 60; ++i) {
+        ipasir_assume(s, 21);
+        ipasir_assume(s, -1);
+    }
+    int res = ipasir_solve(s);
+    ASSERT(res == 20, "There should not be a solution");
+    ASSERT(!ipasir_failed(s, 21), "21 is a unary clause, so it is not needed");
+    ipasir_release(s);
+
+    cout << "Second solve:" << endl;
+    s = solver_from_string("1 2 0\n-1 3 0\n-2 -3 0\n4 5 6 0\n");
+    for (int i = 0; i < 60; ++i) {
+        ipasir_assume(s, 1);
+        ipasir_assume(s, 3);
+    }
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(ipasir_val(s, 2) == -2, "Assignment does not make since");
+    ipasir_release(s);
+
+    cout << "Third solve:" << endl;
+    // The levels of the first solve outnumber the variables, and adding new
+    // ones must not drop them: deciding 5 or 6 false above the assumptions
+    // gives a conflict there.
+    s = solver_from_string("1 2 0\n");
+    for (int i = 0; i < 40; ++i) ipasir_assume(s, i % 2 ? 1 : -2);
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    vector<vector<int>> clauses = clauses_from_string("1 2 0\n3 4 0\n-3 -4 0\n5 6 0\n5 -6 0\n-5 6 0\n-5 -6 7 0\n-1 8 0\n");
+    for (size_t i = 1; i < clauses.size(); ++i) {
+        for (int l : clauses[i]) ipasir_add(s, l);
+        ipasir_add(s, 0);
+    }
+    for (int i = 0; i < 40; ++i) ipasir_assume(s, i % 2 ? 3 : 1);
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(satisfies_all(s, clauses), "Assignment does not make since");
+    ipasir_release(s);
+}
+
+
+// Restarts keep the levels of the assumptions, and trail reuse keeps more,
+// but the inprocessing passes run at level 0 only. So the restarts must still
+// get there when a pass is due.
+void test_inprocessing_under_assumptions() {
+    const int VARS = 200;
+    IpasirSolver s = ipasir_init();
+    unsigned int x = 1;
+    auto next = [&]() { x = x * 1103515245u + 12345u; return (x >> 16) & 0x7fff; };
+    for (int i = 0; i < VARS * 4.26; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            int v = 1 + next() % VARS;
+            ipasir_add(s, next() % 2 ? v : -v);
+        }
+        ipasir_add(s, 0);
+    }
+    for (int k = 0; k < 2; ++k) {
+        ipasir_assume(s, -(3 * k + 1));
+        ipasir_assume(s, 3 * k + 2);
+        ipasir_assume(s, -(3 * k + 3));
+        ipasir_solve(s);
+    }
+    int vivify_runs = S.vivify_pass.runs;
+    ipasir_release(s);
+    cout << "vivify ran " << vivify_runs << " times" << endl;
+    ASSERT(vivify_runs >= 2, "Vivification should run every few thousand conflicts");
+}
+
+
+// -1 implies 5 and then 2 through binary clauses, so vivification cuts
+// (1 2 3 4) down to (1 2). No clause is a subset of another, so it is not
+// subsumption that does it.
+void test_vivified() {
+    OptionGuard no_elim(elim, 0); // it would eliminate 5 first
+    const string problem = "1 5 0  -5 2 0  1 2 3 4 0  -3 -4 6 0\n";
+    IpasirSolver s = solver_from_string(problem);
+    S.vivify_pass.next = 0; // at the first solve, rather than after Vivify_interval conflicts
+    int res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(S.num_vivified == 1 && S.num_vivified_lits == 2, "(1 2 3 4) should become (1 2)");
+    ASSERT(satisfies_all(s, clauses_from_string(problem)), "Assignment does not make since");
+
+    ipasir_assume(s, -1);
+    ipasir_assume(s, -3);
+    ipasir_assume(s, -4);
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(ipasir_val(s, 2) == 2, "-1 implies 2");
+    ipasir_assume(s, -1);
+    ipasir_assume(s, -2);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "-1 implies 2");
+    ASSERT(ipasir_failed(s, -1) && ipasir_failed(s, -2), "Both are needed");
+    ipasir_release(s);
+}
+
+
+// Every variable here is removed by bounded variable elimination, so the
+// values of all of them come from extending the model.
+const string ELIMINABLE = R"(
+    -1 2 0   -1 3 0   1 -2 -3 0
+     1 4 0   -4 5 6 0   -5 -6 0
+     2 5 0   -3 6 0
+)";
+
+
+void test_eliminated_values() {
+    IpasirSolver s = solver_from_string(ELIMINABLE);
+    int res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(S.num_eliminated == 6, "All the variables should be eliminated");
+    ASSERT(satisfies_all(s, clauses_from_string(ELIMINABLE)), "The model must satisfy the clauses of the eliminated variables");
+    ipasir_release(s);
+}
+
+
+void test_eliminated_then_used() {
+    IpasirSolver s = solver_from_string(ELIMINABLE);
+    vector<vector<int>> clauses = clauses_from_string(ELIMINABLE);
+    int res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+
+    cout << "Assuming eliminated variables:" << endl;
+    ipasir_assume(s, 1);
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(ipasir_val(s, 1) == 1 && ipasir_val(s, 6) == 6, "1 implies 3, which implies 6");
+    ASSERT(satisfies_all(s, clauses), "Assignment does not make since");
+    ipasir_assume(s, 1);
+    ipasir_assume(s, -6);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "1 implies 6");
+    ASSERT(ipasir_failed(s, 1) && ipasir_failed(s, -6), "Both are needed");
+
+    cout << "Adding clauses on eliminated variables:" << endl;
+    ipasir_add(s, -2); ipasir_add(s, -4); ipasir_add(s, 0);
+    ipasir_add(s, 4); ipasir_add(s, -5); ipasir_add(s, 0);
+    clauses.push_back({ -2, -4 });
+    clauses.push_back({ 4, -5 });
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(satisfies_all(s, clauses), "Assignment does not make since");
+    ipasir_add(s, 2); ipasir_add(s, 0);
+    ipasir_add(s, 5); ipasir_add(s, 0);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "2 and 5 rule out 4 both ways");
+    ipasir_release(s);
+}
+
+
+// 1, 2 and 3 are equivalent, so substitution replaces them with one of them.
+const string EQUIVALENT = R"(
+    -1 2 0   1 -2 0   -2 3 0   2 -3 0
+     1 4 5 0   -3 -4 5 0   -1 4 -5 0   2 -4 -5 0
+)";
+
+
+void test_substituted_values() {
+    IpasirSolver s = solver_from_string(EQUIVALENT);
+    vector<vector<int>> clauses = clauses_from_string(EQUIVALENT);
+    int res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(S.num_substituted > 0, "Variables should be substituted");
+    ASSERT(satisfies_all(s, clauses), "Assignment does not make since");
+    ASSERT(ipasir_val(s, 1) * 2 == ipasir_val(s, 2) && ipasir_val(s, 2) * 3 == ipasir_val(s, 3) * 2, 
+        "Equivalent variables must get the same value");
+
+    cout << "Adding clauses on substituted variables:" << endl;
+    ipasir_add(s, -2); ipasir_add(s, 0);
+    clauses.push_back({ -2 });
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(satisfies_all(s, clauses), "Assignment does not make since");
+    ASSERT(ipasir_val(s, 1) == -1 && ipasir_val(s, 3) == -3, "Equivalent variables must get the same value");
+    ipasir_add(s, 3); ipasir_add(s, 0);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "2 and 3 are equivalent");
+    ipasir_release(s);
+}
+
+
+// Substitution must not replace assumed (frozen) variables. With two of them
+// in a component, one is the representative and the other one stays too.
+void test_frozen_not_substituted() {
+    IpasirSolver s = solver_from_string(EQUIVALENT);
+    ipasir_assume(s, 1);
+    ipasir_assume(s, -3);
+    int res = ipasir_solve(s);
+    ASSERT(res == 20, "1 and 3 are equivalent");
+    ASSERT(S.num_substituted == 1 && S.eliminated[2], "2 should be substituted");
+    ASSERT(!S.eliminated[1] && !S.eliminated[3], "Assumed variables are kept");
+    ASSERT(ipasir_failed(s, 1) && ipasir_failed(s, -3), "Both are needed");
+
+    ipasir_assume(s, 1);
+    ipasir_assume(s, 3);
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(ipasir_val(s, 2) == 2, "2 is equivalent to 1");
+    ASSERT(satisfies_all(s, clauses_from_string(EQUIVALENT)), "Assignment does not make since");
+    ipasir_release(s);
+}
+
+
+// (1 2 3) subsumes (1 2 3 4), and strengthens (-1 2 3 5) to (2 3 5) by
+// self-subsuming resolution. The clauses must keep their meaning.
+void test_subsumed_and_strengthened() {
+    OptionGuard no_elim(elim, 0); // it would eliminate them first
+    const string problem = "1 2 3 0  1 2 3 4 0  -1 2 3 5 0\n";
+    IpasirSolver s = solver_from_string(problem);
+    vector<vector<int>> clauses = clauses_from_string(problem);
+    int res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(S.num_subsumed == 1 && S.num_strengthened == 1, "One clause should be subsumed, and one strengthened");
+    ASSERT(satisfies_all(s, clauses), "Assignment does not make since");
+
+    ipasir_add(s, -2); ipasir_add(s, 0);
+    ipasir_add(s, -3); ipasir_add(s, 0);
+    clauses.push_back({ -2 });
+    clauses.push_back({ -3 });
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(satisfies_all(s, clauses), "Assignment does not make since");
+    ASSERT(ipasir_val(s, 1) == 1 && ipasir_val(s, 5) == 5, "(1 2 3) and (2 3 5) are left");
+    ipasir_assume(s, -5);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "(2 3 5) is left");
+    ASSERT(ipasir_failed(s, -5), "-5 is needed");
+    ipasir_release(s);
+}
+
+
+// (-1 2 3) removes 1 from (1 2 3 4 5), and then (2 3 -4) removes 4, which
+// comes after it. So the literals that follow a removed one are scanned too.
+void test_strengthened_twice() {
+    OptionGuard no_elim(elim, 0); // it would eliminate them first
+    const string problem = "-1 2 3 0  2 3 -4 0  1 2 3 4 5 0\n";
+    IpasirSolver s = solver_from_string(problem);
+    int res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(S.num_strengthened == 2, "(1 2 3 4 5) should become (2 3 5)");
+    ASSERT(satisfies_all(s, clauses_from_string(problem)), "Assignment does not make since");
+
+    ipasir_assume(s, -2);
+    ipasir_assume(s, -3);
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(ipasir_val(s, 1) == -1 && ipasir_val(s, 4) == -4 && ipasir_val(s, 5) == 5, "-2 and -3 imply -1, -4 and 5");
+    ipasir_assume(s, -2);
+    ipasir_assume(s, -3);
+    ipasir_assume(s, -5);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "(2 3 5) is left");
+    ipasir_release(s);
+}
+
+
+// 1 implies 2 and 3, which exclude each other, so probing 1 fails, and -1
+// is fixed at level 0.
+void test_failed_literal() {
+    OptionGuard no_elim(elim, 0); // it would eliminate them first
+    const string problem = "-1 2 0  -1 3 0  -2 -3 0  1 4 5 0  -4 -5 0\n";
+    IpasirSolver s = solver_from_string(problem);
+    int res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(S.num_failed == 1, "1 should be a failed literal");
+    ASSERT(ipasir_val(s, 1) == -1 && S.dlevel[1] == 0, "-1 should be fixed at level 0");
+    ASSERT(satisfies_all(s, clauses_from_string(problem)), "Assignment does not make since");
+    ipasir_assume(s, 1);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "1 is failed");
+    ASSERT(ipasir_failed(s, 1), "1 is needed");
+    ipasir_release(s);
+}
+
+
+// Probing 1 implies 2 and 3 through binary clauses, and 4 through the long
+// clause (-2 -3 4), so the hyper-binary resolvent (-1 4) is added.
+void test_hyper_binary_resolvent() {
+    OptionGuard no_elim(elim, 0); // it would eliminate them first
+    const string problem = "-1 2 0  -1 3 0  -2 -3 4 0  1 5 6 0  -4 -5 6 0\n";
+    IpasirSolver s = solver_from_string(problem);
+    int res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(S.num_hbrs == 1, "(-1 4) should be added");
+    ASSERT(satisfies_all(s, clauses_from_string(problem)), "Assignment does not make since");
+    ipasir_assume(s, 1);
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(ipasir_val(s, 4) == 4, "1 implies 4");
+    ipasir_assume(s, 1);
+    ipasir_assume(s, -4);
+    res = ipasir_solve(s);
+    ASSERT(res == 20, "1 implies 4");
+    ASSERT(ipasir_failed(s, 1) && ipasir_failed(s, -4), "Both are needed");
+    ipasir_release(s);
+}
+
+
+// Adds clauses to the assignment of a finished solve. In the first one, the
+// literal of 5 is true, but was assigned at a higher level than those of 7 and
+// 1 became false. So the clause implies it at the level of 7, and the solver
+// backtracks there.
+void test_add_implying_clause() {
+    OptionGuard no_elim(elim, 0); // so that the variables stay on the trail
+    const string problem = "1 2 0  3 4 0  5 6 0  -1 -3 -5 7 0\n";
+    IpasirSolver s = solver_from_string(problem);
+    vector<vector<int>> clauses = clauses_from_string(problem);
+    int res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+
+    vector<int> m = solver_get_assignment(s, 7);
+    clauses.push_back({ m[5], -m[7], -m[1] });
+    clauses.push_back({ -m[5], -m[6] }); // 5 and 6 were assigned at the same level: it backtracks below it
+    for (size_t i = clauses.size() - 2; i < clauses.size(); ++i) {
+        for (int l : clauses[i]) ipasir_add(s, l);
+        ipasir_add(s, 0);
+    }
+    res = ipasir_solve(s);
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(satisfies_all(s, clauses), "Assignment does not make since");
+    ipasir_release(s);
+}
+
+
+// Random 3-SAT clauses over the variables 1 .. vars, that all agree with a
+// fixed "planted" assignment in some literal, so that they are satisfiable.
+vector<vector<int>> planted_3sat(int vars, int count, unsigned int seed) {
+    vector<vector<int>> clauses;
+    unsigned int x = seed;
+    auto next = [&]() { x = x * 1103515245u + 12345u; return (x >> 16) & 0x7fff; };
+    auto planted = [](int v) { return (v * 2654435761u >> 7) & 1 ? v : -v; };
+    for (int i = 0; i < count; ++i) {
+        clauses.emplace_back();
+        bool satisfied = false;
+        for (int j = 0; j < 3; ++j) {
+            int v = 1 + next() % vars;
+            clauses.back().push_back(next() % 2 ? v : -v);
+            if (clauses.back().back() == planted(v)) satisfied = true;
+        }
+        if (!satisfied) clauses.back()[0] *= -1;
+    }
+    return clauses;
+}
+
+
+void add_clauses(IpasirSolver s, const vector<vector<int>>& clauses) {
+    for (const auto& clause : clauses) {
+        for (int l : clause) ipasir_add(s, l);
+        ipasir_add(s, 0);
+    }
+}
+
+
+// Each decision heuristic solves a satisfiable instance, grows it with new
+// variables between solves, which go into its queue or heap, and then makes
+// it UNSAT with pigeons on more new variables.
+void test_var_dec_heuristics() {
+    for (VAR_DEC_HEURISTIC h : { VAR_DEC_HEURISTIC::MINISAT, VAR_DEC_HEURISTIC::VMTF, VAR_DEC_HEURISTIC::LRB }) {
+        OptionGuard heuristic((int&)VarDecHeuristic, (int)h);
+        cout << "Heuristic " << (int)h << ":" << endl;
+        vector<vector<int>> clauses = planted_3sat(300, 1260, 7);
+        IpasirSolver s = ipasir_init();
+        add_clauses(s, clauses);
+        int res = ipasir_solve(s);
+        ASSERT(res == 10, "Should succeed");
+        ASSERT(satisfies_all(s, clauses), "Assignment does not make since");
+
+        vector<vector<int>> more = planted_3sat(400, 600, 11);
+        add_clauses(s, more);
+        clauses.insert(clauses.end(), more.begin(), more.end());
+        res = ipasir_solve(s);
+        ASSERT(res == 10, "Should still succeed");
+        ASSERT(satisfies_all(s, clauses), "Assignment does not make since");
+
+        add_clauses(s, clauses_from_string(pigeonhole(5, 4, 401)));
+        res = ipasir_solve(s);
+        ASSERT(res == 20, "5 pigeons do not fit in 4 holes");
+        ipasir_release(s);
+
+        s = solver_from_string(pigeonhole(7, 6));
+        res = ipasir_solve(s);
+        ipasir_release(s);
+        ASSERT(res == 20, "7 pigeons do not fit in 6 holes");
+    }
+}
+
+
+// 8 pigeons in 7 holes take over a thousand conflicts, so each restart policy
+// gets to restart, and the switching one leaves its first (focused) mode.
+// Each policy also runs with target phases, which come from the trails
+// between its restarts.
+void test_restart_policies() {
+    for (RESTART_POLICY p : { RESTART_POLICY::LOCAL, RESTART_POLICY::GLUCOSE, RESTART_POLICY::LUBY, RESTART_POLICY::SWITCHING })
+    for (VAL_DEC_HEURISTIC h : { VAL_DEC_HEURISTIC::PHASESAVING, VAL_DEC_HEURISTIC::TARGET }) {
+        OptionGuard policy((int&)RestartPolicy, (int)p);
+        OptionGuard heuristic((int&)ValDecHeuristic, (int)h);
+        cout << "Policy " << (int)p << ", value heuristic " << (int)h << ":" << endl;
+        vector<vector<int>> clauses = planted_3sat(300, 1260, 13);
+        IpasirSolver s = ipasir_init();
+        add_clauses(s, clauses);
+        int res = ipasir_solve(s);
+        bool satisfied = res == 10 && satisfies_all(s, clauses);
+        ipasir_release(s);
+        ASSERT(res == 10, "Should succeed");
+        ASSERT(satisfied, "Assignment does not make since");
+
+        s = solver_from_string(pigeonhole(8, 7));
+        res = ipasir_solve(s);
+        int restarts = S.num_restarts, mode_switches = S.num_mode_switches, rephases = S.num_rephases;
+        ipasir_release(s);
+        cout << restarts << " restarts, " << mode_switches << " mode switches, " << rephases << " rephases" << endl;
+        ASSERT(res == 20, "8 pigeons do not fit in 7 holes");
+        ASSERT(restarts > 0, "Every policy should restart");
+        ASSERT((mode_switches > 0) == (p == RESTART_POLICY::SWITCHING), "Only the switching policy switches modes");
+    }
+}
+
+
+// A satisfiable random 3-SAT instance with hundreds of decision levels, on
+// which chronological backtracking takes long jumps, and then resolves
+// conflicts below the current level.
+void test_chrono_long_jump() {
+    OptionGuard chronological(::chrono, 1); // qualified, as std::chrono is visible
+    const int VARS = 3000;
+    IpasirSolver s = ipasir_init();
+    vector<vector<int>> clauses;
+    unsigned int x = 5;
+    auto next = [&]() { x = x * 1103515245u + 12345u; return (x >> 16) & 0x7fff; };
+    for (int i = 0; i < VARS * 3.2; ++i) {
+        clauses.emplace_back();
+        for (int j = 0; j < 3; ++j) {
+            int v = 1 + next() % VARS;
+            clauses.back().push_back(next() % 2 ? v : -v);
+            ipasir_add(s, clauses.back().back());
+        }
+        ipasir_add(s, 0);
+    }
+    int res = ipasir_solve(s);
+    int chrono_backtracks = S.num_chrono_backtracks;
+    bool satisfied = res == 10 && satisfies_all(s, clauses);
+    ipasir_release(s);
+    cout << chrono_backtracks << " chronological backtracks" << endl;
+    ASSERT(res == 10, "Should succeed");
+    ASSERT(satisfied, "Assignment does not make since");
+    ASSERT(chrono_backtracks > 0, "Some jumps should be long enough to backtrack chronologically");
+}
+
+
 int main() {
 #ifdef _WIN32
     // We use utf8 characters
@@ -306,6 +923,24 @@ int main() {
     TEST(flipped_assignment_is_wrong);
     TEST(assume_for_incrementality);
     TEST(assume_dissappears);
+    TEST(add_between_solves);
+    TEST(failed_assumptions);
+    TEST(minimized_core);
+    TEST(chrono_long_jump);
+    TEST(var_dec_heuristics);
+    TEST(restart_policies);
+    TEST(repeated_assumptions);
+    TEST(inprocessing_under_assumptions);
+    TEST(vivified);
+    TEST(eliminated_values);
+    TEST(eliminated_then_used);
+    TEST(substituted_values);
+    TEST(frozen_not_substituted);
+    TEST(subsumed_and_strengthened);
+    TEST(strengthened_twice);
+    TEST(failed_literal);
+    TEST(hyper_binary_resolvent);
+    TEST(add_implying_clause);
 
     cout << "End" << endl;
     cout  << endl;